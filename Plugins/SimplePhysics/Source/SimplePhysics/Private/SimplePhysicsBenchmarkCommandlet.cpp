@@ -0,0 +1,203 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SimplePhysicsBenchmarkCommandlet.h"
+
+#include "SimplePhysicsRigidBodyComponent.h"
+#include "SimplePhysicsSolver.h"
+#include "Components/SphereComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/UObjectGlobals.h"
+
+
+namespace SimplePhysicsBenchmark
+{
+	static const float BodyRadius = 10.f;
+	static const float FrameTime = 1.f / 90.f;
+	static const int32 RandomSeed = 1234;
+
+	/** Distance between body centers in each scenario, in body radii */
+	static const float RestingSpacing = 2.5f;
+	static const float FreeFlightSpacing = 8.f;
+	static const float DenseSpacing = 2.2f;
+
+	static const float FreeFlightSpeed = 200.f;
+	static const float DenseSpeed = 300.f;
+}
+
+
+USimplePhysicsBenchmarkCommandlet::USimplePhysicsBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+
+int32 USimplePhysicsBenchmarkCommandlet::Main(const FString& Params)
+{
+	TArray<FString> Tokens;
+	TArray<FString> Switches;
+	TMap<FString, FString> ParamValues;
+	ParseCommandLine(*Params, Tokens, Switches, ParamValues);
+
+	TArray<int32> Counts = { 100, 500, 1000, 5000, 10000 };
+	if (const FString* CountsValue = ParamValues.Find(TEXT("Counts")))
+	{
+		TArray<FString> CountStrings;
+		CountsValue->ParseIntoArray(CountStrings, TEXT(","));
+
+		Counts.Reset();
+		for (const FString& CountString : CountStrings)
+		{
+			Counts.Add(FMath::Max(FCString::Atoi(*CountString), 1));
+		}
+	}
+
+	const FString* FramesValue = ParamValues.Find(TEXT("Frames"));
+	const int32 NumFrames = FramesValue ? FMath::Max(FCString::Atoi(**FramesValue), 1) : 300;
+
+	const FString* OutputValue = ParamValues.Find(TEXT("Output"));
+	const FString OutputFilename = OutputValue ? *OutputValue : FPaths::ProjectSavedDir() / TEXT("SimplePhysicsBenchmark.csv");
+
+	FString Csv = TEXT("Scenario,NumBodies,Frames,Steps,Substeps,AvgContactsPerStep,AvgFrameMs,GatherMs,IntegrateMs,BroadphaseMs,SolveContactsMs,MoveMs,WritebackMs,UsedPhysicalDeltaBytes,BytesPerBody\n");
+
+	for (const EScenario Scenario : { EScenario::Resting, EScenario::FreeFlight, EScenario::DenseCollision })
+	{
+		for (const int32 NumBodies : Counts)
+		{
+			const FString Row = RunScenario(Scenario, NumBodies, NumFrames);
+			UE_LOG(LogTemp, Display, TEXT("%s"), *Row);
+			Csv += Row + TEXT("\n");
+		}
+	}
+
+	if (!FFileHelper::SaveStringToFile(Csv, *OutputFilename))
+	{
+		UE_LOG(LogTemp, Error, TEXT("SimplePhysicsBenchmark could not write %s"), *OutputFilename);
+		return 1;
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("SimplePhysicsBenchmark wrote %s"), *OutputFilename);
+	return 0;
+}
+
+
+FString USimplePhysicsBenchmarkCommandlet::RunScenario(EScenario Scenario, int32 NumBodies, int32 NumFrames) const
+{
+	using namespace SimplePhysicsBenchmark;
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("SimplePhysicsBenchmark"));
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+	World->InitializeActorsForPlay(FURL());
+	World->BeginPlay();
+
+	USimplePhysicsSolver* Solver = World->GetSubsystem<USimplePhysicsSolver>();
+	check(Solver);
+
+	// Bodies are placed on a grid, on the floor when resting and filling the room otherwise
+	const bool bResting = Scenario == EScenario::Resting;
+	const float Spacing = BodyRadius * (bResting ? RestingSpacing : (Scenario == EScenario::FreeFlight ? FreeFlightSpacing : DenseSpacing));
+	const float Speed = bResting ? 0.f : (Scenario == EScenario::FreeFlight ? FreeFlightSpeed : DenseSpeed);
+	const int32 PerSide = bResting ? FMath::CeilToInt(FMath::Sqrt(static_cast<float>(NumBodies))) : FMath::CeilToInt(FMath::Pow(static_cast<float>(NumBodies), 1.f / 3.f));
+	const float HalfSize = PerSide * Spacing * 0.5f + BodyRadius;
+
+	// Box room facing inwards
+	FSimplePhysicsStaticColliderSet Room;
+	const FBox2D FaceBounds(FVector2D(-HalfSize), FVector2D(HalfSize));
+	for (const FVector& Normal : { FVector::UpVector, FVector::DownVector, FVector::ForwardVector, FVector::BackwardVector, FVector::RightVector, FVector::LeftVector })
+	{
+		Room.AddPlane(FTransform(FRotationMatrix::MakeFromX(Normal).ToQuat(), -Normal * HalfSize), FaceBounds);
+	}
+
+	Solver->SetStaticColliders(Room, TArray<AActor*>());
+
+	// Change of the process used physical memory, not an allocation count. Includes anything else the process did meanwhile
+	const uint64 UsedPhysicalBefore = FPlatformMemory::GetStats().UsedPhysical;
+
+	FRandomStream Random(RandomSeed);
+	const FVector GridOrigin(-HalfSize + BodyRadius + Spacing * 0.5f);
+	for (int32 BodyIndex = 0; BodyIndex < NumBodies; ++BodyIndex)
+	{
+		FVector Location;
+		if (bResting)
+		{
+			Location = FVector(GridOrigin.X + (BodyIndex % PerSide) * Spacing, GridOrigin.Y + (BodyIndex / PerSide) * Spacing, -HalfSize + BodyRadius * 1.5f);
+		}
+		else
+		{
+			Location = GridOrigin + FVector(BodyIndex % PerSide, (BodyIndex / PerSide) % PerSide, BodyIndex / (PerSide * PerSide)) * Spacing;
+		}
+
+		SpawnBody(World, Location, Random.GetUnitVector() * Speed, bResting);
+	}
+
+	Solver->ResetStats();
+
+	for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+	{
+		Solver->Tick(FrameTime);
+	}
+
+	const FSimplePhysicsSolverStats Stats = Solver->GetStats();
+	const FSimplePhysicsMemoryFootprint Footprint = Solver->GetMemoryFootprint();
+	const int64 UsedPhysicalDelta = static_cast<int64>(FPlatformMemory::GetStats().UsedPhysical) - static_cast<int64>(UsedPhysicalBefore);
+
+	World->DestroyWorld(false);
+	GEngine->DestroyWorldContext(World);
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+	const double ToFrameMs = 1000.0 / NumFrames;
+	return FString::Printf(TEXT("%s,%d,%d,%d,%d,%.2f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%lld,%llu"),
+		GetScenarioName(Scenario), NumBodies, NumFrames, Stats.NumSteps, Stats.NumSubsteps,
+		Stats.NumSubsteps > 0 ? static_cast<double>(Stats.NumContacts) / Stats.NumSubsteps : 0.0,
+		Stats.GetTotalSeconds() * ToFrameMs, Stats.GatherSeconds * ToFrameMs, Stats.IntegrateSeconds * ToFrameMs, Stats.BroadphaseSeconds * ToFrameMs,
+		Stats.SolveContactsSeconds * ToFrameMs, Stats.MoveSeconds * ToFrameMs, Stats.WritebackSeconds * ToFrameMs, UsedPhysicalDelta,
+		static_cast<uint64>(Footprint.GetBytesPerBody()));
+}
+
+
+void USimplePhysicsBenchmarkCommandlet::SpawnBody(UWorld* World, const FVector& Location, const FVector& InitialVelocity, bool bUseGravity) const
+{
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	AActor* Actor = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform(Location), SpawnParameters);
+
+	USphereComponent* Sphere = NewObject<USphereComponent>(Actor);
+	Sphere->SetSphereRadius(SimplePhysicsBenchmark::BodyRadius);
+	Sphere->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+	Actor->SetRootComponent(Sphere);
+	Sphere->RegisterComponent();
+	Sphere->SetWorldLocation(Location);
+
+	USimplePhysicsRigidBodyComponent* RigidBody = NewObject<USimplePhysicsRigidBodyComponent>(Actor);
+	RigidBody->bUseGravity = bUseGravity;
+	RigidBody->RegisterComponent();
+
+	RigidBody->SetVelocity(InitialVelocity);
+	RigidBody->SetSimulationEnabled(true);
+}
+
+
+const TCHAR* USimplePhysicsBenchmarkCommandlet::GetScenarioName(EScenario Scenario)
+{
+	switch (Scenario)
+	{
+	case EScenario::Resting:
+		return TEXT("Resting");
+
+	case EScenario::FreeFlight:
+		return TEXT("FreeFlight");
+
+	default:
+		return TEXT("DenseCollision");
+	}
+}
@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "SimplePhysicsBenchmarkCommandlet.generated.h"
+
+class UWorld;
+
+
+/**
+ * Measures how USimplePhysicsSolver scales with the number of RigidBodies. Spawns sphere RigidBodies in a box room,
+ * ticks the solver for a fixed number of frames and writes the time spent in each solver phase to a CSV file.
+ * Memory is reported as the solver footprint per body and the change of the process used physical memory over the run.
+ *
+ * Run headless with: UnrealEditor-Cmd <Project> -run=SimplePhysicsBenchmark -nullrhi
+ *	-Counts=100,500,1000	Body counts to measure. Defaults to 100,500,1000,5000,10000
+ *	-Frames=300				Frames ticked per run
+ *	-Output=<File>			CSV file. Defaults to Saved/SimplePhysicsBenchmark.csv
+ */
+UCLASS()
+class USimplePhysicsBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	USimplePhysicsBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+
+	enum class EScenario : uint8
+	{
+		/** Bodies dropped onto the floor under gravity, most of the run is spent asleep */
+		Resting,
+
+		/** Bodies spread far apart, rarely touching */
+		FreeFlight,
+
+		/** Bodies packed closely in a small room */
+		DenseCollision
+	};
+
+	/** Run a single scenario with NumBodies and return its CSV row */
+	FString RunScenario(EScenario Scenario, int32 NumBodies, int32 NumFrames) const;
+
+	/** Spawn a sphere RigidBody. Simulation is enabled with InitialVelocity */
+	void SpawnBody(UWorld* World, const FVector& Location, const FVector& InitialVelocity, bool bUseGravity) const;
+
+	static const TCHAR* GetScenarioName(EScenario Scenario);
+};
@@ -0,0 +1,25 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SimplePhysicsBodyProfile.h"
+
+
+USimplePhysicsBodyProfile::USimplePhysicsBodyProfile()
+{
+	// Same defaults as USimplePhysicsRigidBodyComponent
+	bUseGravity = false;
+	GravityScale = 1.f;
+	bEnableSimulationOnRigidBodyCollision = true;
+	Friction = 0.2f;
+	MinFrictionFraction = 0.f;
+	Bounciness = 0.6f;
+	LinearDamping = 0.f;
+	AngularDamping = 0.f;
+	MaxSpeed = 1000.f;
+	MaxAngularVelocity = 0.f;
+	BounceCombine = EBounceCombine::Minimum;
+	bBounceAngleAffectsFriction = false;
+	TempScale = 0.f;
+	CollisionCategoryBits = 1;
+	CollisionMaskBits = -1;
+}
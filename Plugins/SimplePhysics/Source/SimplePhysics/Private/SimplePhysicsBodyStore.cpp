@@ -0,0 +1,555 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SimplePhysicsBodyStore.h"
+
+#include "SimplePhysicsRigidBodyComponent.h"
+#include "SimplePhysicsVectorLanes.h"
+#include "Components/PrimitiveComponent.h"
+
+
+FSimplePhysicsBodyParams::FSimplePhysicsBodyParams()
+	:
+	LinearDamping(0.f),
+	AngularDamping(0.f),
+	GravityZ(0.f),
+	MaxSpeed(0.f),
+	MaxAngularVelocity(0.f),
+	Friction(0.f),
+	MinFrictionFraction(0.f),
+	Bounciness(0.f),
+	TempScale(0.f),
+	BounceCombine(EBounceCombine::Minimum),
+	bBounceAngleAffectsFriction(false),
+	bEnableSimulationOnRigidBodyCollision(false),
+	PlaneConstraintNormal(FVector::ZeroVector)
+{}
+
+
+FVector FSimplePhysicsBodyParams::LimitVelocity(FVector NewVelocity) const
+{
+	if (MaxSpeed > 0.f)
+	{
+		NewVelocity = NewVelocity.GetClampedToMaxSize(MaxSpeed);
+	}
+
+	if (!PlaneConstraintNormal.IsZero())
+	{
+		NewVelocity = FVector::VectorPlaneProject(NewVelocity, PlaneConstraintNormal);
+	}
+
+	return NewVelocity;
+}
+
+
+FVector FSimplePhysicsBodyParams::LimitAngularVelocity(FVector NewAngularVelocity) const
+{
+	if (MaxAngularVelocity > 0.f)
+	{
+		NewAngularVelocity = NewAngularVelocity.GetClampedToMaxSize(MaxAngularVelocity);
+	}
+
+	// TODO: Contrain rotation to plane
+	return NewAngularVelocity;
+}
+
+
+FVector FSimplePhysicsBodyParams::ConstrainNormalToPlane(const FVector& Normal) const
+{
+	if (!PlaneConstraintNormal.IsZero())
+	{
+		return FVector::VectorPlaneProject(Normal, PlaneConstraintNormal).GetSafeNormal();
+	}
+
+	return Normal;
+}
+
+
+float FSimplePhysicsBodyParams::GetRestitutionCoefficient(const FSimplePhysicsBodyParams& OtherParams) const
+{
+	float RestitutionCoefficient = Bounciness;
+
+	switch (BounceCombine)
+	{
+	case EBounceCombine::Maximum:
+		RestitutionCoefficient = FMath::Max(Bounciness, OtherParams.Bounciness);
+		break;
+
+	case EBounceCombine::Minimum:
+		RestitutionCoefficient = FMath::Min(Bounciness, OtherParams.Bounciness);
+		break;
+
+	case EBounceCombine::Average:
+		RestitutionCoefficient = (Bounciness + OtherParams.Bounciness) / 2.f;
+		break;
+
+		// No need for EBounceCombine::Ignore to set RestitutionCoefficient to current value
+
+	default:
+		break;
+	}
+
+	return FMath::Clamp(RestitutionCoefficient, 0.f, 1.f);
+}
+
+
+FSimplePhysicsBodyStore::FSimplePhysicsBodyStore()
+	:
+	NumSimulating(0),
+	NumSleeping(0),
+	NumRemoved(0)
+{}
+
+
+int32 FSimplePhysicsBodyStore::Add(USimplePhysicsRigidBodyComponent* Component)
+{
+	check(Component && !Component->BodyHandle.IsValid());
+
+	int32 Slot;
+	if (FreeSlots.Num() > 0)
+	{
+		Slot = FreeSlots.Pop();
+	}
+	else
+	{
+		Slot = SlotIndices.Add(INDEX_NONE);
+		SlotGenerations.Add(0);
+	}
+
+	const int32 Index = Components.Add(Component);
+	SlotIndices[Slot] = Index;
+	BodySlots.Add(Slot);
+	Positions.Add(FVector::ZeroVector);
+	Velocities.Add(Component->Velocity);
+	AngularVelocities.Add(Component->AngularVelocity);
+	PendingForces.Add(FVector::ZeroVector);
+	PendingTorques.Add(FVector::ZeroVector);
+	Radii.Add(0.f);
+	InverseMasses.Add(0.f);
+	InverseMomentsOfInertia.Add(0.f);
+	Params.AddDefaulted();
+	Simulating.Add(false);
+	Sleeping.Add(false);
+	SleepMoveHandles.AddDefaulted();
+	CollisionEnabled.Add(false);
+	CollisionFilters.AddDefaulted();
+	PendingSimulation.Add(ESimplePhysicsPendingSimulation::None);
+	BounceEventIndices.Add(INDEX_NONE);
+	UpdateIntervals.Add(1);
+	LastUpdateSteps.Add(0);
+
+	Component->BodyHandle = FSimplePhysicsBodyHandle(Slot, SlotGenerations[Slot]);
+
+	RefreshParams(Index);
+	ReadComponentState(Index);
+
+	return Index;
+}
+
+
+SIZE_T FSimplePhysicsBodyStore::GetAllocatedSize() const
+{
+	return Components.GetAllocatedSize() + Positions.GetAllocatedSize() + Velocities.GetAllocatedSize() + AngularVelocities.GetAllocatedSize() +
+		PendingForces.GetAllocatedSize() + PendingTorques.GetAllocatedSize() + Radii.GetAllocatedSize() + InverseMasses.GetAllocatedSize() +
+		InverseMomentsOfInertia.GetAllocatedSize() + Params.GetAllocatedSize() + Simulating.GetAllocatedSize() + Sleeping.GetAllocatedSize() +
+		SleepMoveHandles.GetAllocatedSize() + CollisionEnabled.GetAllocatedSize() + CollisionFilters.GetAllocatedSize() + PendingSimulation.GetAllocatedSize() +
+		BounceEventIndices.GetAllocatedSize() + UpdateIntervals.GetAllocatedSize() + LastUpdateSteps.GetAllocatedSize() +
+		BodySlots.GetAllocatedSize() + SlotIndices.GetAllocatedSize() + SlotGenerations.GetAllocatedSize() + FreeSlots.GetAllocatedSize();
+}
+
+
+FSimplePhysicsBodyHandle FSimplePhysicsBodyStore::GetHandle(int32 Index) const
+{
+	if (!IsValidIndex(Index))
+	{
+		return FSimplePhysicsBodyHandle();
+	}
+
+	const int32 Slot = BodySlots[Index];
+	return FSimplePhysicsBodyHandle(Slot, SlotGenerations[Slot]);
+}
+
+
+int32 FSimplePhysicsBodyStore::FindIndex(const FSimplePhysicsBodyHandle& Handle) const
+{
+	if (!SlotIndices.IsValidIndex(Handle.Slot) || SlotGenerations[Handle.Slot] != Handle.Generation)
+	{
+		return INDEX_NONE;
+	}
+
+	return SlotIndices[Handle.Slot];
+}
+
+
+int32 FSimplePhysicsBodyStore::FindIndex(const USimplePhysicsRigidBodyComponent* Component) const
+{
+	return Component ? FindIndex(Component->BodyHandle) : INDEX_NONE;
+}
+
+
+void FSimplePhysicsBodyStore::Remove(int32 Index)
+{
+	if (!IsValidIndex(Index))
+	{
+		return;
+	}
+
+	SetSimulating(Index, false);
+	SetSleeping(Index, false);
+	CollisionEnabled[Index] = false;
+	PendingSimulation[Index] = ESimplePhysicsPendingSimulation::None;
+	BounceEventIndices[Index] = INDEX_NONE;
+
+	// Free the slot now, the dense index is released by Compact()
+	const int32 Slot = BodySlots[Index];
+	SlotIndices[Slot] = INDEX_NONE;
+	++SlotGenerations[Slot];
+	FreeSlots.Add(Slot);
+	BodySlots[Index] = INDEX_NONE;
+
+	Components[Index]->BodyHandle.Reset();
+	Components[Index] = nullptr;
+	++NumRemoved;
+}
+
+
+bool FSimplePhysicsBodyStore::Compact()
+{
+	const bool bAnyRemoved = NumRemoved > 0;
+
+	for (int32 Index = Num() - 1; Index >= 0 && NumRemoved > 0; --Index)
+	{
+		if (Components[Index] == nullptr)
+		{
+			RemoveAtSwap(Index);
+			--NumRemoved;
+		}
+	}
+
+	return bAnyRemoved;
+}
+
+
+void FSimplePhysicsBodyStore::RemoveAtSwap(int32 Index)
+{
+	Components.RemoveAtSwap(Index);
+	Positions.RemoveAtSwap(Index);
+	Velocities.RemoveAtSwap(Index);
+	AngularVelocities.RemoveAtSwap(Index);
+	PendingForces.RemoveAtSwap(Index);
+	PendingTorques.RemoveAtSwap(Index);
+	Radii.RemoveAtSwap(Index);
+	InverseMasses.RemoveAtSwap(Index);
+	InverseMomentsOfInertia.RemoveAtSwap(Index);
+	Params.RemoveAtSwap(Index);
+	Simulating.RemoveAtSwap(Index);
+	Sleeping.RemoveAtSwap(Index);
+	SleepMoveHandles.RemoveAtSwap(Index);
+	CollisionEnabled.RemoveAtSwap(Index);
+	CollisionFilters.RemoveAtSwap(Index);
+	PendingSimulation.RemoveAtSwap(Index);
+	BounceEventIndices.RemoveAtSwap(Index);
+	UpdateIntervals.RemoveAtSwap(Index);
+	LastUpdateSteps.RemoveAtSwap(Index);
+	BodySlots.RemoveAtSwap(Index);
+
+	// The last body was moved into Index
+	if (IsValidIndex(Index))
+	{
+		SlotIndices[BodySlots[Index]] = Index;
+	}
+}
+
+
+void FSimplePhysicsBodyStore::SetSimulating(int32 Index, bool bSimulating)
+{
+	if (Simulating[Index] != bSimulating)
+	{
+		Simulating[Index] = bSimulating;
+		NumSimulating += bSimulating ? 1 : -1;
+	}
+}
+
+
+void FSimplePhysicsBodyStore::SetSleeping(int32 Index, bool bSleeping)
+{
+	if (Sleeping[Index] != bSleeping)
+	{
+		Sleeping[Index] = bSleeping;
+		NumSleeping += bSleeping ? 1 : -1;
+	}
+}
+
+
+void FSimplePhysicsBodyStore::RefreshParams(int32 Index)
+{
+	const USimplePhysicsRigidBodyComponent* Component = Components[Index];
+
+	Params[Index] = Component->GetBodyParams();
+
+	const float Mass = Component->GetMass();
+	InverseMasses[Index] = (Mass > 0.f) ? 1.f / Mass : 0.f;
+
+	CollisionFilters[Index].CategoryBits = Component->GetCollisionCategoryBits();
+	CollisionFilters[Index].MaskBits = Component->GetCollisionMaskBits();
+}
+
+
+bool FSimplePhysicsBodyStore::ReadComponentState(int32 Index)
+{
+	const USimplePhysicsRigidBodyComponent* Component = Components[Index];
+	const UPrimitiveComponent* Primitive = Component->UpdatedPrimitive;
+
+	if (!IsValid(Primitive))
+	{
+		const bool bChanged = CollisionEnabled[Index];
+		CollisionEnabled[Index] = false;
+		return bChanged;
+	}
+
+	const FVector Location = Primitive->GetComponentLocation();
+	const float Radius = Component->GetScaledSphereRadius();
+	const bool bCollisionEnabled = (Radius > 0.f) && Primitive->IsQueryCollisionEnabled();
+
+	// Moment of inertia can depend on the radius, so update it with the radius
+	const float MomentOfInertia = Component->GetMomentOfInertia();
+	const float InverseMomentOfInertia = (MomentOfInertia > 0.f) ? 1.f / MomentOfInertia : 0.f;
+
+	const bool bChanged = Positions[Index] != Location || Radii[Index] != Radius || CollisionEnabled[Index] != bCollisionEnabled ||
+		InverseMomentsOfInertia[Index] != InverseMomentOfInertia;
+
+	Positions[Index] = Location;
+	Radii[Index] = Radius;
+	CollisionEnabled[Index] = bCollisionEnabled;
+	InverseMomentsOfInertia[Index] = InverseMomentOfInertia;
+	return bChanged;
+}
+
+
+bool FSimplePhysicsBodyStore::ReadCollisionState(int32 Index)
+{
+	const UPrimitiveComponent* Primitive = Components[Index]->UpdatedPrimitive;
+	const bool bCollisionEnabled = IsValid(Primitive) && (Radii[Index] > 0.f) && Primitive->IsQueryCollisionEnabled();
+
+	if (CollisionEnabled[Index] == bCollisionEnabled)
+	{
+		return false;
+	}
+
+	CollisionEnabled[Index] = bCollisionEnabled;
+	return true;
+}
+
+
+void FSimplePhysicsBodyStore::WriteComponentState(int32 Index) const
+{
+	if (USimplePhysicsRigidBodyComponent* Component = Components[Index])
+	{
+		Component->Velocity = Velocities[Index];
+		Component->AngularVelocity = AngularVelocities[Index];
+		Component->UpdateComponentVelocity();
+	}
+}
+
+
+void FSimplePhysicsBodyStore::SetVelocity(int32 Index, const FVector& NewVelocity)
+{
+	Velocities[Index] = Params[Index].LimitVelocity(NewVelocity);
+}
+
+
+void FSimplePhysicsBodyStore::SetAngularVelocity(int32 Index, const FVector& NewAngularVelocity)
+{
+	AngularVelocities[Index] = Params[Index].LimitAngularVelocity(NewAngularVelocity);
+}
+
+
+void FSimplePhysicsBodyStore::SetMovementData(int32 Index, const FMovementData& MovementData)
+{
+	SetVelocity(Index, MovementData.LinearVelocity);
+	SetAngularVelocity(Index, MovementData.AngularVelocity);
+}
+
+
+FVector FSimplePhysicsBodyStore::ComputeAcceleration(int32 Index, const FVector& InitialVelocity) const
+{
+	const FSimplePhysicsBodyParams& BodyParams = Params[Index];
+
+	FVector Acceleration(FVector::ZeroVector);
+	Acceleration.Z -= BodyParams.GravityZ;
+
+	// Linear drag
+	FVector Force = 0.5f * -InitialVelocity.GetSafeNormal() * InitialVelocity.SizeSquared() * BodyParams.LinearDamping;
+	Force += PendingForces[Index];
+
+	Acceleration += Force * InverseMasses[Index];
+
+	return Acceleration;
+}
+
+
+FVector FSimplePhysicsBodyStore::ComputeVelocity(int32 Index, const FVector& InitialVelocity, float DeltaTime) const
+{
+	// v = v0 + a*t
+	const FVector Acceleration = ComputeAcceleration(Index, InitialVelocity);
+	const FVector NewVelocity = InitialVelocity + (Acceleration * DeltaTime);
+
+	return Params[Index].LimitVelocity(NewVelocity);
+}
+
+
+FVector FSimplePhysicsBodyStore::ComputeMoveDelta(int32 Index, const FVector& InVelocity, float DeltaTime) const
+{
+	// Velocity Verlet integration (http://en.wikipedia.org/wiki/Verlet_integration#Velocity_Verlet)
+	// The addition of p0 is done outside this method, we are just computing the delta.
+	// p = p0 + v0*t + 1/2*a*t^2
+
+	// We use ComputeVelocity() here to infer the acceleration, to make it easier to apply custom velocities.
+	// p = p0 + v0*t + 1/2*((v1-v0)/t)*t^2
+	// p = p0 + v0*t + 1/2*((v1-v0))*t
+
+	const FVector NewVelocity = ComputeVelocity(Index, InVelocity, DeltaTime);
+	const FVector Delta = (InVelocity * DeltaTime) + (NewVelocity - InVelocity) * (0.5f * DeltaTime);
+	return Delta;
+}
+
+
+FVector FSimplePhysicsBodyStore::ComputeAngularAcceleration(int32 Index, const FVector& InitialAngularVelocity) const
+{
+	// Angular drag
+	FVector Torque = -Params[Index].AngularDamping * InitialAngularVelocity;
+	Torque += PendingTorques[Index];
+
+	return Torque * InverseMomentsOfInertia[Index];
+}
+
+
+FVector FSimplePhysicsBodyStore::ComputeAngularVelocity(int32 Index, const FVector& InitialAngularVelocity, float DeltaTime) const
+{
+	const FVector AngularAcceleration = ComputeAngularAcceleration(Index, InitialAngularVelocity);
+	const FVector NewAngularVelocity = InitialAngularVelocity + (AngularAcceleration * DeltaTime);
+
+	return Params[Index].LimitAngularVelocity(NewAngularVelocity);
+}
+
+
+FVector FSimplePhysicsBodyStore::ComputeAngularVelocityDelta(int32 Index, const FVector& InAngularVelocity, float DeltaTime) const
+{
+	const FVector NewAngularVelocity = ComputeAngularVelocity(Index, InAngularVelocity, DeltaTime);
+	return (InAngularVelocity * DeltaTime) + (NewAngularVelocity - InAngularVelocity) * (0.5f * DeltaTime);
+}
+
+
+void FSimplePhysicsBodyStore::UpdateMovementVelocity(int32 Index, const FVector& OldVelocity, const FVector& OldAngularVelocity, float DeltaTime)
+{
+	if (Velocities[Index] == OldVelocity)
+	{
+		Velocities[Index] = ComputeVelocity(Index, OldVelocity, DeltaTime);
+	}
+
+	if (AngularVelocities[Index] == OldAngularVelocity)
+	{
+		AngularVelocities[Index] = ComputeAngularVelocity(Index, OldAngularVelocity, DeltaTime);
+	}
+}
+
+
+void FSimplePhysicsBodyStore::Integrate(int32 Index, float DeltaTime, FSimplePhysicsIntegrationResult& OutResult) const
+{
+	const FVector& StartVelocity = Velocities[Index];
+	const FVector& StartAngularVelocity = AngularVelocities[Index];
+
+	OutResult.StartVelocity = StartVelocity;
+	OutResult.StartAngularVelocity = StartAngularVelocity;
+	OutResult.Velocity = ComputeVelocity(Index, StartVelocity, DeltaTime);
+	OutResult.AngularVelocity = ComputeAngularVelocity(Index, StartAngularVelocity, DeltaTime);
+
+	// Same as ComputeMoveDelta() and ComputeAngularVelocityDelta() without computing the new velocities again
+	OutResult.MoveDelta = (StartVelocity * DeltaTime) + (OutResult.Velocity - StartVelocity) * (0.5f * DeltaTime);
+	OutResult.AngularVelocityDelta = (StartAngularVelocity * DeltaTime) + (OutResult.AngularVelocity - StartAngularVelocity) * (0.5f * DeltaTime);
+}
+
+
+void FSimplePhysicsBodyStore::IntegrateBatch(const int32* BodyIndices, int32 NumIndices, const float* DeltaTimes, FSimplePhysicsIntegrationResult* OutResults) const
+{
+	using namespace SimplePhysicsLanes;
+
+	const VectorRegister4Double Half = Splat(0.5);
+
+	for (int32 BatchStart = 0; BatchStart < NumIndices; BatchStart += Width)
+	{
+		// Pad the last batch by repeating its last body. Padded lanes are computed but never written
+		const int32 NumLanes = FMath::Min(Width, NumIndices - BatchStart);
+		int32 Indices[Width];
+		for (int32 Lane = 0; Lane < Width; ++Lane)
+		{
+			Indices[Lane] = BodyIndices[BatchStart + FMath::Min(Lane, NumLanes - 1)];
+		}
+
+		const VectorRegister4Double Time = MakeVectorRegisterDouble(DeltaTimes[Indices[0]], DeltaTimes[Indices[1]], DeltaTimes[Indices[2]], DeltaTimes[Indices[3]]);
+		const VectorRegister4Double HalfTime = VectorMultiply(Time, Half);
+
+		const FVectorLanes StartVelocity = LoadVectors(Velocities, Indices);
+		const FVectorLanes StartAngularVelocity = LoadVectors(AngularVelocities, Indices);
+
+		// Linear drag, same as -0.5 * Velocity.GetSafeNormal() * Velocity.SizeSquared() * LinearDamping
+		const VectorRegister4Double SpeedSquared = Dot(StartVelocity, StartVelocity);
+		const VectorRegister4Double DragScale = VectorSelect(
+			VectorCompareGE(SpeedSquared, Splat(UE_SMALL_NUMBER)),
+			VectorMultiply(VectorSqrt(SpeedSquared), VectorMultiply(Splat(-0.5), Load(Params, &FSimplePhysicsBodyParams::LinearDamping, Indices))),
+			GlobalVectorConstants::DoubleZero);
+
+		FVectorLanes Acceleration = Scale(ScaleAdd(StartVelocity, DragScale, LoadVectors(PendingForces, Indices)), Load(InverseMasses, Indices));
+		Acceleration.Z = VectorSubtract(Acceleration.Z, Load(Params, &FSimplePhysicsBodyParams::GravityZ, Indices));
+
+		// v = v0 + a*t, then FSimplePhysicsBodyParams::LimitVelocity(). Projecting on a zero plane normal leaves the velocity unchanged
+		FVectorLanes Velocity = ClampToMaxSize(ScaleAdd(Acceleration, Time, StartVelocity), Load(Params, &FSimplePhysicsBodyParams::MaxSpeed, Indices));
+
+		const FVectorLanes PlaneNormal = LoadVectors(Params, &FSimplePhysicsBodyParams::PlaneConstraintNormal, Indices);
+		Velocity = Subtract(Velocity, Scale(PlaneNormal, Dot(Velocity, PlaneNormal)));
+
+		// Angular drag and torque, then FSimplePhysicsBodyParams::LimitAngularVelocity()
+		const VectorRegister4Double NegativeAngularDamping = VectorNegate(Load(Params, &FSimplePhysicsBodyParams::AngularDamping, Indices));
+		const FVectorLanes AngularAcceleration = Scale(ScaleAdd(StartAngularVelocity, NegativeAngularDamping, LoadVectors(PendingTorques, Indices)), Load(InverseMomentsOfInertia, Indices));
+		const FVectorLanes AngularVelocity = ClampToMaxSize(ScaleAdd(AngularAcceleration, Time, StartAngularVelocity), Load(Params, &FSimplePhysicsBodyParams::MaxAngularVelocity, Indices));
+
+		// Velocity Verlet, see ComputeMoveDelta()
+		const FVectorLanes MoveDelta = ScaleAdd(Subtract(Velocity, StartVelocity), HalfTime, Scale(StartVelocity, Time));
+		const FVectorLanes AngularVelocityDelta = ScaleAdd(Subtract(AngularVelocity, StartAngularVelocity), HalfTime, Scale(StartAngularVelocity, Time));
+
+		FVector VelocityOut[Width];
+		FVector AngularVelocityOut[Width];
+		FVector MoveDeltaOut[Width];
+		FVector AngularVelocityDeltaOut[Width];
+		StoreVectors(Velocity, VelocityOut);
+		StoreVectors(AngularVelocity, AngularVelocityOut);
+		StoreVectors(MoveDelta, MoveDeltaOut);
+		StoreVectors(AngularVelocityDelta, AngularVelocityDeltaOut);
+
+		for (int32 Lane = 0; Lane < NumLanes; ++Lane)
+		{
+			const int32 Index = Indices[Lane];
+			FSimplePhysicsIntegrationResult& Result = OutResults[Index];
+			Result.StartVelocity = Velocities[Index];
+			Result.StartAngularVelocity = AngularVelocities[Index];
+			Result.Velocity = VelocityOut[Lane];
+			Result.AngularVelocity = AngularVelocityOut[Lane];
+			Result.MoveDelta = MoveDeltaOut[Lane];
+			Result.AngularVelocityDelta = AngularVelocityDeltaOut[Lane];
+		}
+	}
+}
+
+
+void FSimplePhysicsBodyStore::ApplyIntegrationResult(int32 Index, const FSimplePhysicsIntegrationResult& Result)
+{
+	if (Velocities[Index] == Result.StartVelocity)
+	{
+		Velocities[Index] = Result.Velocity;
+	}
+
+	if (AngularVelocities[Index] == Result.StartAngularVelocity)
+	{
+		AngularVelocities[Index] = Result.AngularVelocity;
+	}
+}
@@ -0,0 +1,170 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SimplePhysicsBroadphase.h"
+
+
+const int32 FSimplePhysicsSpatialHash::MAX_SEGMENT_PIECES = 256;
+
+
+FSimplePhysicsSpatialHash::FSimplePhysicsSpatialHash()
+	:
+	CellSize(100.f),
+	InvCellSize(1.f / 100.f)
+{
+}
+
+
+void FSimplePhysicsSpatialHash::Reset(float NewCellSize)
+{
+	CellSize = FMath::Max(NewCellSize, 1.f);
+	InvCellSize = 1.f / CellSize;
+
+	CellHeads.Reset();
+	CellEntries.Reset();
+	EntryBounds.Reset();
+	EntryMinCells.Reset();
+}
+
+
+FIntVector FSimplePhysicsSpatialHash::GetCell(const FVector& Location) const
+{
+	return FIntVector(
+		FMath::FloorToInt(Location.X * InvCellSize),
+		FMath::FloorToInt(Location.Y * InvCellSize),
+		FMath::FloorToInt(Location.Z * InvCellSize));
+}
+
+
+void FSimplePhysicsSpatialHash::Insert(int32 Index, const FBox& Bounds)
+{
+	check(Index >= 0);
+
+	if (EntryBounds.Num() <= Index)
+	{
+		EntryBounds.SetNum(Index + 1);
+		EntryMinCells.SetNum(Index + 1);
+	}
+
+	const FIntVector MinCell = GetCell(Bounds.Min);
+	const FIntVector MaxCell = GetCell(Bounds.Max);
+
+	EntryBounds[Index] = Bounds;
+	EntryMinCells[Index] = MinCell;
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+			{
+				int32& Head = CellHeads.FindOrAdd(FIntVector(X, Y, Z), INDEX_NONE);
+				Head = CellEntries.Add({ Index, Head });
+			}
+		}
+	}
+}
+
+
+void FSimplePhysicsSpatialHash::Query(const FBox& Bounds, TArray<int32>& OutIndices) const
+{
+	const FIntVector MinCell = GetCell(Bounds.Min);
+	const FIntVector MaxCell = GetCell(Bounds.Max);
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+			{
+				const int32* Head = CellHeads.Find(FIntVector(X, Y, Z));
+				if (!Head)
+				{
+					continue;
+				}
+
+				for (int32 Entry = *Head; Entry != INDEX_NONE; Entry = CellEntries[Entry].Next)
+				{
+					const int32 Index = CellEntries[Entry].Index;
+
+					// An entry in several cells is only reported from the lowest cell both bounds touch
+					const FIntVector& EntryMinCell = EntryMinCells[Index];
+					const FIntVector SharedMinCell(FMath::Max(MinCell.X, EntryMinCell.X), FMath::Max(MinCell.Y, EntryMinCell.Y), FMath::Max(MinCell.Z, EntryMinCell.Z));
+					if (SharedMinCell != FIntVector(X, Y, Z))
+					{
+						continue;
+					}
+
+					if (EntryBounds[Index].Intersect(Bounds))
+					{
+						OutIndices.Add(Index);
+					}
+				}
+			}
+		}
+	}
+}
+
+
+void FSimplePhysicsSpatialHash::QuerySegment(const FVector& Start, const FVector& End, float Radius, TArray<int32>& OutIndices) const
+{
+	const int32 FirstResult = OutIndices.Num();
+	const FVector Segment = End - Start;
+	const int32 NumPieces = FMath::Clamp(FMath::CeilToInt32(Segment.Size() * InvCellSize), 1, MAX_SEGMENT_PIECES);
+
+	for (int32 Piece = 0; Piece < NumPieces; ++Piece)
+	{
+		const FVector PieceStart = Start + Segment * (float(Piece) / NumPieces);
+		const FVector PieceEnd = Start + Segment * (float(Piece + 1) / NumPieces);
+		Query(FBox(PieceStart.ComponentMin(PieceEnd), PieceStart.ComponentMax(PieceEnd)).ExpandBy(Radius), OutIndices);
+	}
+
+	// Neighbouring pieces share cells, so entries can be reported more than once
+	TArrayView<int32> Results = MakeArrayView(OutIndices).Slice(FirstResult, OutIndices.Num() - FirstResult);
+	Results.Sort();
+
+	if (NumPieces > 1)
+	{
+		int32 NumUnique = 0;
+		for (int32 ResultIndex = 0; ResultIndex < Results.Num(); ++ResultIndex)
+		{
+			if (NumUnique == 0 || Results[ResultIndex] != Results[NumUnique - 1])
+			{
+				Results[NumUnique++] = Results[ResultIndex];
+			}
+		}
+
+		OutIndices.SetNum(FirstResult + NumUnique);
+	}
+}
+
+
+void FSimplePhysicsSpatialHash::GatherCandidatePairs(TArray<FSimplePhysicsCandidatePair>& OutPairs) const
+{
+	for (const auto& Cell : CellHeads)
+	{
+		for (int32 EntryA = Cell.Value; EntryA != INDEX_NONE; EntryA = CellEntries[EntryA].Next)
+		{
+			const int32 IndexA = CellEntries[EntryA].Index;
+
+			for (int32 EntryB = CellEntries[EntryA].Next; EntryB != INDEX_NONE; EntryB = CellEntries[EntryB].Next)
+			{
+				const int32 IndexB = CellEntries[EntryB].Index;
+
+				// Two entries can share several cells. Only report the pair from the lowest cell both entries touch
+				const FIntVector& MinCellA = EntryMinCells[IndexA];
+				const FIntVector& MinCellB = EntryMinCells[IndexB];
+				const FIntVector SharedMinCell(FMath::Max(MinCellA.X, MinCellB.X), FMath::Max(MinCellA.Y, MinCellB.Y), FMath::Max(MinCellA.Z, MinCellB.Z));
+				if (SharedMinCell != Cell.Key)
+				{
+					continue;
+				}
+
+				if (EntryBounds[IndexA].Intersect(EntryBounds[IndexB]))
+				{
+					OutPairs.Emplace(IndexA, IndexB);
+				}
+			}
+		}
+	}
+}
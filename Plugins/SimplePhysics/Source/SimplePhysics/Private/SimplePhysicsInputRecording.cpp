@@ -0,0 +1,120 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SimplePhysicsInputRecording.h"
+
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+
+namespace SimplePhysicsInputRecording
+{
+	static const uint32 FileMagic = 0x52495053; // SPIR
+	static const int32 FileVersion = 3;
+}
+
+
+FArchive& operator<<(FArchive& Ar, FSimplePhysicsInputRecord& Record)
+{
+	Ar << Record.Type;
+
+	switch (Record.Type)
+	{
+	case ESimplePhysicsInputType::Frame:
+		Ar << Record.Scalar;
+		break;
+
+	case ESimplePhysicsInputType::SetSimulationEnabled:
+	case ESimplePhysicsInputType::SetIgnoreGroup:
+	case ESimplePhysicsInputType::AddImpulse:
+		Ar << Record.BodyId << Record.Value << Record.Scalar;
+		break;
+
+	case ESimplePhysicsInputType::AddForce:
+	case ESimplePhysicsInputType::AddTorque:
+	case ESimplePhysicsInputType::SetVelocity:
+	case ESimplePhysicsInputType::SetAngularVelocity:
+		Ar << Record.BodyId << Record.Value;
+		break;
+
+	default:
+		Ar << Record.BodyId;
+		break;
+	}
+
+	return Ar;
+}
+
+
+void FSimplePhysicsInputRecording::Reset()
+{
+	Records.Reset();
+	BodyPaths.Reset();
+	StaticColliderSets.Reset();
+	SimulationBounds.Reset();
+}
+
+
+bool FSimplePhysicsInputRecording::SaveToFile(const FString& Filename)
+{
+	TArray<uint8> Data;
+	FMemoryWriter Writer(Data);
+	Serialize(Writer);
+
+	return FFileHelper::SaveArrayToFile(Data, *Filename);
+}
+
+
+bool FSimplePhysicsInputRecording::LoadFromFile(const FString& Filename)
+{
+	Reset();
+
+	TArray<uint8> Data;
+	if (!FFileHelper::LoadFileToArray(Data, *Filename))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(Data);
+	Serialize(Reader);
+
+	if (Reader.IsError())
+	{
+		Reset();
+		return false;
+	}
+
+	return true;
+}
+
+
+void FSimplePhysicsInputRecording::Serialize(FArchive& Ar)
+{
+	uint32 Magic = SimplePhysicsInputRecording::FileMagic;
+	int32 Version = SimplePhysicsInputRecording::FileVersion;
+	Ar << Magic << Version;
+
+	if (Ar.IsLoading() && (Magic != SimplePhysicsInputRecording::FileMagic || Version != SimplePhysicsInputRecording::FileVersion))
+	{
+		Ar.SetError();
+		return;
+	}
+
+	Ar << BodyPaths;
+
+	int32 NumStaticColliderSets = StaticColliderSets.Num();
+	Ar << NumStaticColliderSets;
+	if (Ar.IsLoading())
+	{
+		StaticColliderSets.SetNum(NumStaticColliderSets);
+	}
+
+	for (FSimplePhysicsStaticColliderSet& StaticColliderSet : StaticColliderSets)
+	{
+		StaticColliderSet.Serialize(Ar);
+	}
+
+	Ar << SimulationBounds;
+	Ar << Records;
+}
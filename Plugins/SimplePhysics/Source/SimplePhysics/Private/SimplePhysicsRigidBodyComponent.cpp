@@ -4,6 +4,7 @@
 #include "SimplePhysicsRigidBodyComponent.h"
 
 #include "SimplePhysics_Settings.h"
+#include "SimplePhysicsBodyProfile.h"
 #include "SimplePhysicsSolver.h"
 #include "Components/SphereComponent.h"
 
@@ -19,23 +20,21 @@ USimplePhysicsRigidBodyComponent::USimplePhysicsRigidBodyComponent()
 	MaxSpeed = 1000.f;
 	GravityScale = 1.f;
 	MomentOfInertia = 1.f;
-	CalculatedMomentOfInertia = 0.1f;
+	CollisionCategoryBits = 1;
+	CollisionMaskBits = -1;
 
 
 	/*PreviousHitTime = 1.f;
 	PreviousHitNormal = FVector::UpVector;*/
 	//bBounceAngleAffectsFriction = false;
-	LastHitResult.Init();
-
-	PendingTorque = FVector::ZeroVector;
 }
 
 
 float USimplePhysicsRigidBodyComponent::GetScaledSphereRadius() const
 {
-	if (OwnerSphereComponent)
+	if (const USphereComponent* SphereComponent = GetSphereComponent())
 	{
-		return OwnerSphereComponent->GetScaledSphereRadius();
+		return SphereComponent->GetScaledSphereRadius();
 	}
 
 	UE_LOG(LogTemp, Warning, TEXT("I am here !!!!!"));
@@ -54,7 +53,14 @@ float USimplePhysicsRigidBodyComponent::CalculateMomentOfInertia() const
 void USimplePhysicsRigidBodyComponent::SetMass(float NewMass)
 {
 	Mass = NewMass;
-	//CalculatedMomentOfInertia = CalculateMomentOfInertia();
+	RefreshBodyParams();
+}
+
+
+void USimplePhysicsRigidBodyComponent::SetMomentOfInertia(float NewMomentOfInertia)
+{
+	MomentOfInertia = NewMomentOfInertia;
+	RefreshBodyParams();
 }
 
 
@@ -90,15 +96,21 @@ void USimplePhysicsRigidBodyComponent::InitializeComponent()
 {
 	Super::InitializeComponent();
 
-	if (USimplePhysics_Settings* SimplePhysicsSettings = GetMutableDefault<USimplePhysics_Settings>())
+	if (auto Subsystem = GetSimplePhysicsSolver())
 	{
-		GravityAcceleration = SimplePhysicsSettings->GravityAcceleration;
+		Subsystem->AddRigidBody(this);
 	}
+}
+
 
-	if (IsValid(UpdatedComponent))
+void USimplePhysicsRigidBodyComponent::UninitializeComponent()
+{
+	if (auto Subsystem = GetSimplePhysicsSolver())
 	{
-		OwnerSphereComponent = Cast<USphereComponent>(UpdatedComponent);
+		Subsystem->RemoveRigidBody(this);
 	}
+
+	Super::UninitializeComponent();
 }
 
 
@@ -129,101 +141,19 @@ void USimplePhysicsRigidBodyComponent::SetSimulationEnabled(bool Enabled)
 
 void USimplePhysicsRigidBodyComponent::AddForce(const FVector& Force)
 {
-	PendingForce += Force;
+	if (auto Subsystem = GetSimplePhysicsSolver())
+	{
+		Subsystem->AddForce(this, Force);
+	}
 }
 
 
 void USimplePhysicsRigidBodyComponent::AddTorque(const FVector& Torque)
 {
-	PendingTorque += Torque;
-}
-
-
-FVector USimplePhysicsRigidBodyComponent::ComputeAngularVelocityDelta(const FVector& InAngularVelocity, float DeltaTime) const
-{
-	const FVector NewAngularVelocity = ComputeAngularVelocity(InAngularVelocity, DeltaTime);
-	const FVector Delta = (InAngularVelocity * DeltaTime) + (NewAngularVelocity - InAngularVelocity) * (0.5f * DeltaTime);
-
-	return Delta;//FRotator(Delta.Y, Delta.Z, Delta.X);
-}
-
-
-FVector USimplePhysicsRigidBodyComponent::ComputeAngularVelocity(const FVector& InitialAngularVelocity, float DeltaTime) const
-{
-	const FVector AngularAcceleration = ComputeAngularAcceleration(InitialAngularVelocity, DeltaTime);
-	const FVector NewAngularVelocity = InitialAngularVelocity + (AngularAcceleration * DeltaTime);
-
-	return LimitAngularVelocity(NewAngularVelocity);
-}
-
-
-FVector USimplePhysicsRigidBodyComponent::ComputeAngularAcceleration(const FVector& InitialAngularVelocity, float DeltaTime) const
-{
-	const float CurrentMomentOfInertia = GetMomentOfInertia();
-	check(CurrentMomentOfInertia > 0.f);
-
-	FVector Torque = GetAngularDragTorque(InitialAngularVelocity);
-	Torque += GetPendingTorque();
-
-	const FVector AngularAcceleration = Torque / CurrentMomentOfInertia;
-	return AngularAcceleration;
-}
-
-
-FVector USimplePhysicsRigidBodyComponent::GetAngularDragTorque(const FVector& InAngularVelocity) const
-{
-	return -AngularDamping * InAngularVelocity;
-}
-
-
-FVector USimplePhysicsRigidBodyComponent::GetLinearDragForce(const FVector& InVelocity) const
-{
-	return 0.5f * -InVelocity.GetSafeNormal() * InVelocity.SizeSquared() * LinearDamping;
-}
-
-
-FVector USimplePhysicsRigidBodyComponent::ComputeMoveDelta(const FVector& InVelocity, float DeltaTime) const
-{
-	// Velocity Verlet integration (http://en.wikipedia.org/wiki/Verlet_integration#Velocity_Verlet)
-    // The addition of p0 is done outside this method, we are just computing the delta.
-    // p = p0 + v0*t + 1/2*a*t^2
-    
-    // We use ComputeVelocity() here to infer the acceleration, to make it easier to apply custom velocities.
-    // p = p0 + v0*t + 1/2*((v1-v0)/t)*t^2
-    // p = p0 + v0*t + 1/2*((v1-v0))*t
-
-	const FVector NewVelocity = ComputeVelocity(InVelocity, DeltaTime);
-	const FVector Delta = (InVelocity * DeltaTime) + (NewVelocity - InVelocity) * (0.5f * DeltaTime);
-	return Delta;
-}
-
-
-FVector USimplePhysicsRigidBodyComponent::ComputeVelocity(const FVector& InitialVelocity, float DeltaTime) const
-{
-	// v = v0 + a*t
-	const FVector Acceleration = ComputeAcceleration(InitialVelocity, DeltaTime);
-	const FVector NewVelocity = InitialVelocity + (Acceleration * DeltaTime);
-
-	return LimitVelocity(NewVelocity);
-}
-
-FVector USimplePhysicsRigidBodyComponent::ComputeAcceleration(const FVector& InitialVelocity, float DeltaTime) const
-{
-	check(Mass > 0.f);
-
-	FVector Acceleration(FVector::ZeroVector);
-
-	if (bUseGravity)
+	if (auto Subsystem = GetSimplePhysicsSolver())
 	{
-		Acceleration.Z -= GetGravityZ();
+		Subsystem->AddTorque(this, Torque);
 	}
-
-	FVector Force = GetLinearDragForce(InitialVelocity);
-	Force += GetPendingForce();
-
-	Acceleration += (Force / Mass);
-
-	return Acceleration;
 }
 
 
@@ -231,6 +161,11 @@ void USimplePhysicsRigidBodyComponent::SetVelocity(const FVector& NewVelocity, b
 {
 	Velocity = LimitVelocity(NewVelocity);
 
+	if (auto Subsystem = GetSimplePhysicsSolver())
+	{
+		Subsystem->SetVelocity(this, Velocity);
+	}
+
 	if (UpdateVelocity)
 	{
 		UpdateComponentVelocity();
@@ -241,6 +176,20 @@ void USimplePhysicsRigidBodyComponent::SetVelocity(const FVector& NewVelocity, b
 void USimplePhysicsRigidBodyComponent::SetAngularVelocity(const FVector& NewAngularVelocity)
 {
 	AngularVelocity = LimitAngularVelocity(NewAngularVelocity);
+
+	if (auto Subsystem = GetSimplePhysicsSolver())
+	{
+		Subsystem->SetAngularVelocity(this, AngularVelocity);
+	}
+}
+
+
+void USimplePhysicsRigidBodyComponent::SetIgnoreGroup(int32 GroupId, float Duration)
+{
+	if (auto Subsystem = GetSimplePhysicsSolver())
+	{
+		Subsystem->SetIgnoreGroup(this, GroupId, Duration);
+	}
 }
 
 
@@ -248,38 +197,12 @@ void USimplePhysicsRigidBodyComponent::SetMovementData(const FMovementData& Move
 {
 	SetVelocity(MovementData.LinearVelocity);
 	SetAngularVelocity(MovementData.AngularVelocity);
-
-	//UE_LOG(LogTemp, Warning, TEXT("AngularVelocity: %s"), *AngularVelocity.ToString());
 }
 
 
 float USimplePhysicsRigidBodyComponent::GetRestitutionCoefficient(TObjectPtr<USimplePhysicsRigidBodyComponent> OtherRidigBody) const
 {
-	const float OtherRigidBodyBounciness = OtherRidigBody->Bounciness;
-
-	float RestitutionCoefficient = Bounciness;
-
-	switch (BounceCombine)
-	{
-	case EBounceCombine::Maximum:
-		RestitutionCoefficient = FMath::Max(Bounciness, OtherRigidBodyBounciness);
-		break;
-
-	case EBounceCombine::Minimum:
-		RestitutionCoefficient = FMath::Min(Bounciness, OtherRigidBodyBounciness);
-		break;
-
-	case EBounceCombine::Average:
-		RestitutionCoefficient = (Bounciness + OtherRigidBodyBounciness) / 2.f;
-		break;
-
-		// No need for EBounceCombine::Average to set RigidBodyBouceFactor to current value
-
-	default:
-		break;
-	}
-
-	return FMath::Clamp(RestitutionCoefficient, 0.f, 1.f);
+	return GetBodyParams().GetRestitutionCoefficient(OtherRidigBody->GetBodyParams());
 }
 
 
@@ -295,18 +218,6 @@ FVector USimplePhysicsRigidBodyComponent::LimitVelocity(FVector NewVelocity) con
 }
 
 
-FVector USimplePhysicsRigidBodyComponent::LimitVelocityFromCurrent()
-{
-	const float CurrentMaxSpeed = GetMaxSpeed();
-	if (CurrentMaxSpeed > 0.f)
-	{
-		Velocity = Velocity.GetClampedToMaxSize(CurrentMaxSpeed);
-	}
-
-	return ConstrainDirectionToPlane(Velocity);
-}
-
-
 FVector USimplePhysicsRigidBodyComponent::LimitAngularVelocity(FVector NewAngularVelocity) const
 {
 	const float CurrentMaxAngularVelocity = GetMaxAngularVelocity();
@@ -320,94 +231,141 @@ FVector USimplePhysicsRigidBodyComponent::LimitAngularVelocity(FVector NewAngula
 }
 
 
-void USimplePhysicsRigidBodyComponent::UpdateMovementVelocity(const FVector& OldVelocity, float DeltaTime)
+void USimplePhysicsRigidBodyComponent::StopAllMovementImmediately()
 {
-	LastHitResult.Time = 1.f;
-	//bIsSliding = false;
-
-	if (Velocity == OldVelocity)
-	{
-		Velocity = ComputeVelocity(Velocity, DeltaTime);
-	}
+	SetVelocity(FVector::ZeroVector);
 }
 
 
-void USimplePhysicsRigidBodyComponent::UpdateMovementVelocity(const FVector& OldVelocity, const FHitResult& Hit, float DeltaTime)
+bool USimplePhysicsRigidBodyComponent::HasStoppedSimulation() const
 {
-	if (!Hit.bBlockingHit)
+	if ((UpdatedComponent == nullptr) || !IsActive())
 	{
-		UpdateMovementVelocity(OldVelocity, DeltaTime);
-		return;
+		return false;
 	}
 
-	if (Velocity == OldVelocity)
+	if (auto Subsystem = GetSimplePhysicsSolver())
 	{
-		const FVector NewVelocity = ComputeVelocity(OldVelocity, DeltaTime * Hit.Time);
-		Velocity = (Hit.Time > UE_KINDA_SMALL_NUMBER) ? NewVelocity : OldVelocity;
+		return Subsystem->IsSimulating(this);
 	}
+
+	return false;
 }
 
 
-void USimplePhysicsRigidBodyComponent::UpdateMovementAngularVelocity(const FVector& OldAngularVelocity, float DeltaTime)
+float USimplePhysicsRigidBodyComponent::GetGravityZ() const
 {
-	if (AngularVelocity == OldAngularVelocity)
+	const bool bProfileUseGravity = BodyProfile ? BodyProfile->bUseGravity : bUseGravity;
+	if (!bProfileUseGravity)
 	{
-		AngularVelocity = ComputeAngularVelocity(AngularVelocity, DeltaTime);
+		return 0.f;
 	}
+
+	// Read from the settings each time, so components do not each keep a copy
+	return GetDefault<USimplePhysics_Settings>()->GravityAcceleration * (BodyProfile ? BodyProfile->GravityScale : GravityScale);
 }
 
 
-void USimplePhysicsRigidBodyComponent::UpdateMovementAngularVelocity(const FVector& OldAngularVelocity, const FHitResult& Hit, float DeltaTime)
+float USimplePhysicsRigidBodyComponent::GetMaxSpeed() const
 {
-	if (!Hit.bBlockingHit)
-	{
-		UpdateMovementAngularVelocity(OldAngularVelocity, DeltaTime);
-		return;
-	}
+	return BodyProfile ? BodyProfile->MaxSpeed : MaxSpeed;
+}
 
-	if (AngularVelocity == OldAngularVelocity)
-	{
-		const FVector NewAngularVelocity = ComputeAngularVelocity(OldAngularVelocity, DeltaTime * Hit.Time);
-		AngularVelocity = (Hit.Time > UE_KINDA_SMALL_NUMBER) ? NewAngularVelocity : OldAngularVelocity;	
-	}
+
+float USimplePhysicsRigidBodyComponent::GetMaxAngularVelocity() const
+{
+	return BodyProfile ? BodyProfile->MaxAngularVelocity : MaxAngularVelocity;
 }
 
 
-void USimplePhysicsRigidBodyComponent::StopAllMovementImmediately()
+const USphereComponent* USimplePhysicsRigidBodyComponent::GetSphereComponent() const
 {
-	SetVelocity(FVector::ZeroVector);
+	return Cast<USphereComponent>(UpdatedComponent);
 }
 
 
-bool USimplePhysicsRigidBodyComponent::HasStoppedSimulation() const
+const FHitResult& USimplePhysicsRigidBodyComponent::GetLastHitResult() const
 {
-	if ((UpdatedComponent == nullptr) || !IsActive())
+	static const FHitResult NoHitResult(1.f);
+
+	if (auto Subsystem = GetSimplePhysicsSolver())
 	{
-		return false;
+		if (const FHitResult* LastHitResult = Subsystem->FindLastHitResult(this))
+		{
+			return *LastHitResult;
+		}
 	}
 
+	return NoHitResult;
+}
+
+
+void USimplePhysicsRigidBodyComponent::ClearLastBlockingHitResult()
+{
 	if (auto Subsystem = GetSimplePhysicsSolver())
 	{
-		return Subsystem->IsSimulating(this);
+		Subsystem->ClearLastHitResult(this);
 	}
+}
 
-	return false;
+
+FSimplePhysicsBodyParams USimplePhysicsRigidBodyComponent::GetBodyParams() const
+{
+	FSimplePhysicsBodyParams Params;
+	Params.GravityZ = GetGravityZ();
+	Params.MaxSpeed = GetMaxSpeed();
+	Params.MaxAngularVelocity = GetMaxAngularVelocity();
+	Params.PlaneConstraintNormal = bConstrainToPlane ? GetPlaneConstraintNormal() : FVector::ZeroVector;
+
+	if (BodyProfile)
+	{
+		Params.LinearDamping = BodyProfile->LinearDamping;
+		Params.AngularDamping = BodyProfile->AngularDamping;
+		Params.Friction = BodyProfile->Friction;
+		Params.MinFrictionFraction = BodyProfile->MinFrictionFraction;
+		Params.Bounciness = BodyProfile->Bounciness;
+		Params.TempScale = BodyProfile->TempScale;
+		Params.BounceCombine = BodyProfile->BounceCombine;
+		Params.bBounceAngleAffectsFriction = BodyProfile->bBounceAngleAffectsFriction;
+		Params.bEnableSimulationOnRigidBodyCollision = BodyProfile->bEnableSimulationOnRigidBodyCollision;
+		return Params;
+	}
+
+	Params.LinearDamping = LinearDamping;
+	Params.AngularDamping = AngularDamping;
+	Params.Friction = Friction;
+	Params.MinFrictionFraction = MinFrictionFraction;
+	Params.Bounciness = Bounciness;
+	Params.TempScale = TempScale;
+	Params.BounceCombine = BounceCombine;
+	Params.bBounceAngleAffectsFriction = bBounceAngleAffectsFriction;
+	Params.bEnableSimulationOnRigidBodyCollision = bEnableSimulationOnRigidBodyCollision;
+
+	return Params;
 }
 
 
-float USimplePhysicsRigidBodyComponent::GetGravityZ() const
+uint32 USimplePhysicsRigidBodyComponent::GetCollisionCategoryBits() const
 {
-	return bUseGravity ? GravityAcceleration * GravityScale : 0.f;
+	return static_cast<uint32>(BodyProfile ? BodyProfile->CollisionCategoryBits : CollisionCategoryBits);
 }
 
 
-void USimplePhysicsRigidBodyComponent::SetLastBlockingHitResult(const FHitResult& Hit)
+uint32 USimplePhysicsRigidBodyComponent::GetCollisionMaskBits() const
 {
-	LastHitResult = Hit;
+	return static_cast<uint32>(BodyProfile ? BodyProfile->CollisionMaskBits : CollisionMaskBits);
 }
 
 
-void USimplePhysicsRigidBodyComponent::ClearLastBlockingHitResult()
+void USimplePhysicsRigidBodyComponent::RefreshBodyParams()
 {
-	LastHitResult.Init();
+	if (!BodyHandle.IsValid())
+	{
+		return;
+	}
+
+	if (auto Subsystem = GetSimplePhysicsSolver())
+	{
+		Subsystem->RefreshRigidBody(this);
+	}
 }
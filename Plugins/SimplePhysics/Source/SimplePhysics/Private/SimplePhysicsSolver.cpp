@@ -6,16 +6,131 @@
 //#include "SimplePhysics.h"
 #include "SimplePhysics_Settings.h"
 #include "SimplePhysicsRigidBodyComponent.h"
+#include "SimplePhysicsVectorLanes.h"
+#include "Camera/PlayerCameraManager.h"
 #include "Components/SphereComponent.h"
 #include "DrawDebugHelpers.h"
+#include "Engine/OverlapResult.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "Async/ParallelFor.h"
+#include "Tasks/Task.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+#include "ProfilingDebugging/ScopedTimers.h"
+
+
+UE_TRACE_EVENT_BEGIN(SimplePhysics, FrameStats)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(float, SolverMilliseconds)
+	UE_TRACE_EVENT_FIELD(uint32, Simulating)
+	UE_TRACE_EVENT_FIELD(uint32, Sleeping)
+	UE_TRACE_EVENT_FIELD(uint32, Added)
+	UE_TRACE_EVENT_FIELD(uint32, Removed)
+	UE_TRACE_EVENT_FIELD(uint32, Contacts)
+	UE_TRACE_EVENT_FIELD(uint32, Iterations)
+	UE_TRACE_EVENT_FIELD(uint32, Aborts)
+	UE_TRACE_EVENT_FIELD(uint32, Steps)
+	UE_TRACE_EVENT_FIELD(uint32, QualityLevel)
+UE_TRACE_EVENT_END()
+
+
+static FAutoConsoleCommandWithWorld SimplePhysicsFootprintCommand(
+	TEXT("SimplePhysics.Footprint"),
+	TEXT("Log the memory used per RigidBody by the SimplePhysics solver of the current world"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		const USimplePhysicsSolver* Solver = World ? World->GetSubsystem<USimplePhysicsSolver>() : nullptr;
+		if (!Solver)
+		{
+			return;
+		}
+
+		const FSimplePhysicsMemoryFootprint Footprint = Solver->GetMemoryFootprint();
+		UE_LOG(LogTemp, Display, TEXT("SimplePhysics: %d bodies, component %llu bytes, body store %llu bytes, side tables %llu bytes, %llu bytes per body"),
+			Footprint.NumBodies, static_cast<uint64>(Footprint.ComponentBytes), static_cast<uint64>(Footprint.BodyStoreBytes),
+			static_cast<uint64>(Footprint.SideTableBytes), static_cast<uint64>(Footprint.GetBytesPerBody()));
+	}));
 
 
 const float USimplePhysicsSolver::MIN_TICK_TIME = 1e-6f;
+const int32 USimplePhysicsSolver::QUALITY_LOWER_FRAMES = 4;
+const float USimplePhysicsSolver::QUALITY_COST_SMOOTHING = 0.25f;
+const float USimplePhysicsSolver::CONTACT_CONVERGED_VELOCITY = 0.1f;
+const float USimplePhysicsSolver::CONTACT_CACHE_MIN_NORMAL_DOT = 0.95f;
+const int32 USimplePhysicsSolver::MIN_PARALLEL_QUERIES = 16;
+
+
+FSimplePhysicsQuality FSimplePhysicsQuality::Lerp(const FSimplePhysicsQuality& Lowest, float Alpha) const
+{
+	FSimplePhysicsQuality Result;
+	Result.MaxSimulationIterations = FMath::RoundToInt(FMath::Lerp(static_cast<float>(MaxSimulationIterations), static_cast<float>(Lowest.MaxSimulationIterations), Alpha));
+	Result.ContactSolverIterations = FMath::RoundToInt(FMath::Lerp(static_cast<float>(ContactSolverIterations), static_cast<float>(Lowest.ContactSolverIterations), Alpha));
+	Result.MaxSubsteps = FMath::RoundToInt(FMath::Lerp(static_cast<float>(MaxSubsteps), static_cast<float>(Lowest.MaxSubsteps), Alpha));
+	Result.MinimumSimulationVelocity = FMath::Lerp(MinimumSimulationVelocity, Lowest.MinimumSimulationVelocity, Alpha);
+	return Result;
+}
+
 
 USimplePhysicsSolver::USimplePhysicsSolver()
 {
 	MaxSimulationIterations = 3;
 	MinimumSimulationVelocity = 0.01f;
+	WakeContactTolerance = 1.f;
+	ContactSolverIterations = 4;
+	bWarmStartContacts = true;
+	ContactWarmStartFactor = 0.9f;
+	RestingContactSpeed = 50.f;
+	RestingContactLifetimeSteps = 4;
+	bDepenetrateStuckBodies = true;
+	MaxDepenetrationDistance = 25.f;
+	bDetectEscapedBodies = true;
+	EscapedBodyMargin = 50.f;
+	bKeepLastHitResults = true;
+	bSleepingBroadphaseDirty = true;
+	bQueryIndexDirty = true;
+	SimulationBounds = FBox(ForceInit);
+	BroadphaseCellSize = 0.f;
+	RigidBodyObjectType = ECollisionChannel::ECC_GameTraceChannel3;
+	bTeleportContactFreeBodies = true;
+	bParallelIntegration = true;
+	ParallelIntegrationBatchSize = 32;
+	bAsyncStepping = false;
+	AsyncStageTime = 0.f;
+	AsyncStageStep = 0;
+	bAsyncStageReady = false;
+	AsyncStageTaskSeconds = 0.0;
+	BodyStateGeneration = 0;
+	AsyncStageGeneration = 0;
+	bApplyingDeferredInput = false;
+	bUseFixedTimestep = false;
+	FixedTimestep = 1.f / 90.f;
+	MaxStepsPerFrame = 4;
+	bInterpolateFixedSteps = true;
+	bUseSubstepping = false;
+	MaxSubsteps = 4;
+	SubstepMaxTravelFraction = 0.5f;
+	bUseSignificance = false;
+	SignificanceFullRateDistance = 150.f;
+	SignificanceHalfRateDistance = 400.f;
+	bReduceRateOutOfView = true;
+	bUseFrameBudget = false;
+	FrameBudgetMilliseconds = 2.f;
+	FrameBudgetQualityLevels = 4;
+	FrameBudgetRecoverFraction = 0.75f;
+	FrameBudgetRecoverFrames = 60;
+	QualityLevel = 0;
+	SmoothedFrameMilliseconds = 0.0;
+	FramesAtQualityLevel = 0;
+	FramesBelowRecoverBudget = 0;
+	StepAccumulator = 0.f;
+	StepCount = 0;
+	SimulationTime = 0.0;
+	LastIgnoreGroup = 0;
+	InputMode = EInputMode::None;
+	ReplayRecordIndex = 0;
+	bApplyingReplayInput = false;
 }
 
 
@@ -27,7 +142,292 @@ void USimplePhysicsSolver::PostInitialize()
 	{
 		MaxSimulationIterations = SimplePhysicsSettings->MaxSimulationIterations;
 		MinimumSimulationVelocity = SimplePhysicsSettings->MinimumSimulationVelocity;
+		WakeContactTolerance = SimplePhysicsSettings->WakeContactTolerance;
+		ContactSolverIterations = FMath::Max(SimplePhysicsSettings->ContactSolverIterations, 1);
+		bWarmStartContacts = SimplePhysicsSettings->bWarmStartContacts;
+		ContactWarmStartFactor = FMath::Clamp(SimplePhysicsSettings->ContactWarmStartFactor, 0.f, 1.f);
+		RestingContactSpeed = FMath::Max(SimplePhysicsSettings->RestingContactSpeed, 0.f);
+		RestingContactLifetimeSteps = FMath::Max(SimplePhysicsSettings->RestingContactLifetimeSteps, 1);
+		bDepenetrateStuckBodies = SimplePhysicsSettings->bDepenetrateStuckBodies;
+		MaxDepenetrationDistance = FMath::Max(SimplePhysicsSettings->MaxDepenetrationDistance, 0.f);
+		bDetectEscapedBodies = SimplePhysicsSettings->bDetectEscapedBodies;
+		EscapedBodyMargin = FMath::Max(SimplePhysicsSettings->EscapedBodyMargin, 0.f);
+		bKeepLastHitResults = SimplePhysicsSettings->bKeepLastHitResults;
+		BroadphaseCellSize = SimplePhysicsSettings->BroadphaseCellSize;
+		RigidBodyObjectType = SimplePhysicsSettings->RigidBodyObjectType;
+		bTeleportContactFreeBodies = SimplePhysicsSettings->bTeleportContactFreeBodies;
+		bParallelIntegration = SimplePhysicsSettings->bParallelIntegration;
+		ParallelIntegrationBatchSize = FMath::Max(SimplePhysicsSettings->ParallelIntegrationBatchSize, 1);
+		bAsyncStepping = SimplePhysicsSettings->bAsyncStepping;
+		bUseFixedTimestep = SimplePhysicsSettings->bUseFixedTimestep;
+		FixedTimestep = FMath::Max(SimplePhysicsSettings->FixedTimestep, 0.001f);
+		MaxStepsPerFrame = FMath::Max(SimplePhysicsSettings->MaxStepsPerFrame, 1);
+		bInterpolateFixedSteps = SimplePhysicsSettings->bInterpolateFixedSteps;
+		bUseSubstepping = SimplePhysicsSettings->bUseSubstepping;
+		MaxSubsteps = FMath::Max(SimplePhysicsSettings->MaxSubsteps, 1);
+		SubstepMaxTravelFraction = FMath::Max(SimplePhysicsSettings->SubstepMaxTravelFraction, 0.01f);
+		bUseSignificance = SimplePhysicsSettings->bUseSignificance;
+		SignificanceFullRateDistance = SimplePhysicsSettings->SignificanceFullRateDistance;
+		SignificanceHalfRateDistance = FMath::Max(SimplePhysicsSettings->SignificanceHalfRateDistance, SignificanceFullRateDistance);
+		bReduceRateOutOfView = SimplePhysicsSettings->bReduceRateOutOfView;
+		bUseFrameBudget = SimplePhysicsSettings->bUseFrameBudget;
+		FrameBudgetMilliseconds = FMath::Max(SimplePhysicsSettings->FrameBudgetMilliseconds, 0.01f);
+		FrameBudgetQualityLevels = FMath::Max(SimplePhysicsSettings->FrameBudgetQualityLevels, 2);
+		FrameBudgetRecoverFraction = FMath::Clamp(SimplePhysicsSettings->FrameBudgetRecoverFraction, 0.f, 1.f);
+		FrameBudgetRecoverFrames = FMath::Max(SimplePhysicsSettings->FrameBudgetRecoverFrames, 1);
+
+		// The lowest quality never asks for more work than full quality
+		LowestQuality.MaxSimulationIterations = FMath::Clamp(SimplePhysicsSettings->LowestQualitySimulationIterations, 1, FMath::Max(MaxSimulationIterations, 1));
+		LowestQuality.ContactSolverIterations = FMath::Clamp(SimplePhysicsSettings->LowestQualityContactSolverIterations, 1, ContactSolverIterations);
+		LowestQuality.MaxSubsteps = FMath::Clamp(SimplePhysicsSettings->LowestQualityMaxSubsteps, 1, MaxSubsteps);
+		LowestQuality.MinimumSimulationVelocity = FMath::Max(SimplePhysicsSettings->LowestQualityMinimumSimulationVelocity, MinimumSimulationVelocity);
+	}
+
+	FullQuality.MaxSimulationIterations = MaxSimulationIterations;
+	FullQuality.ContactSolverIterations = ContactSolverIterations;
+	FullQuality.MaxSubsteps = MaxSubsteps;
+	FullQuality.MinimumSimulationVelocity = MinimumSimulationVelocity;
+
+	UWorld* World = GetWorld();
+	if (World && World->IsGameWorld())
+	{
+		FString InputFilename;
+		if (FParse::Value(FCommandLine::Get(), TEXT("SimplePhysicsReplay="), InputFilename))
+		{
+			StartInputReplay(InputFilename);
+		}
+		else if (FParse::Value(FCommandLine::Get(), TEXT("SimplePhysicsRecord="), InputFilename))
+		{
+			StartInputRecording(InputFilename);
+		}
+	}
+}
+
+
+void USimplePhysicsSolver::Deinitialize()
+{
+	CompleteAsyncStage();
+
+	if (IsRecordingInput())
+	{
+		StopInputRecording();
+	}
+
+	Super::Deinitialize();
+}
+
+
+void USimplePhysicsSolver::StartInputRecording(const FString& Filename)
+{
+	InputMode = EInputMode::Record;
+	InputRecording.Reset();
+	InputRecordingFilename = Filename;
+	RecordedBodyIds.Reset();
+
+	// Bodies added before recording started are recorded with their first input
+	if (!StaticColliders.IsEmpty())
+	{
+		InputRecording.Records.Emplace(ESimplePhysicsInputType::SetStaticColliders, InputRecording.StaticColliderSets.Add(StaticColliders));
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("SimplePhysics recording input to %s"), *Filename);
+}
+
+
+bool USimplePhysicsSolver::StopInputRecording()
+{
+	if (!IsRecordingInput())
+	{
+		return false;
+	}
+
+	InputMode = EInputMode::None;
+	RecordedBodyIds.Reset();
+
+	const bool bSaved = InputRecording.SaveToFile(InputRecordingFilename);
+	UE_LOG(LogTemp, Log, TEXT("SimplePhysics saved %d input records to %s: %s"), InputRecording.Records.Num(), *InputRecordingFilename, bSaved ? TEXT("Success") : TEXT("Failed"));
+
+	InputRecording.Reset();
+	return bSaved;
+}
+
+
+bool USimplePhysicsSolver::StartInputReplay(const FString& Filename)
+{
+	if (!InputRecording.LoadFromFile(Filename))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("SimplePhysics could not load input recording %s"), *Filename);
+		InputMode = EInputMode::None;
+		return false;
+	}
+
+	InputMode = EInputMode::Replay;
+	InputRecordingFilename = Filename;
+	ReplayRecordIndex = 0;
+	ReplayBodies.Reset();
+
+	UE_LOG(LogTemp, Log, TEXT("SimplePhysics replaying %d input records from %s"), InputRecording.Records.Num(), *Filename);
+	return true;
+}
+
+
+void USimplePhysicsSolver::RecordInput(ESimplePhysicsInputType Type, int32 BodyIndex, const FVector& Value, float Scalar)
+{
+	if (!IsRecordingInput() || !Bodies.IsValidIndex(BodyIndex))
+	{
+		return;
+	}
+
+	const FSimplePhysicsBodyHandle Handle = Bodies.GetHandle(BodyIndex);
+	int32 BodyId = INDEX_NONE;
+	if (const int32* RecordedBodyId = RecordedBodyIds.Find(Handle))
+	{
+		BodyId = *RecordedBodyId;
+	}
+	else
+	{
+		if (Type == ESimplePhysicsInputType::RemoveBody)
+		{
+			return;
+		}
+
+		BodyId = InputRecording.BodyPaths.Add(Bodies.Components[BodyIndex]->GetPathName(GetWorld()));
+		RecordedBodyIds.Add(Handle, BodyId);
+		InputRecording.Records.Emplace(ESimplePhysicsInputType::AddBody, BodyId);
+	}
+
+	InputRecording.Records.Emplace(Type, BodyId, Value, Scalar);
+
+	if (Type == ESimplePhysicsInputType::RemoveBody)
+	{
+		RecordedBodyIds.Remove(Handle);
+	}
+}
+
+
+float USimplePhysicsSolver::ReplayInputs(float DeltaTime)
+{
+	TGuardValue<bool> ApplyingReplayInputGuard(bApplyingReplayInput, true);
+
+	while (InputRecording.Records.IsValidIndex(ReplayRecordIndex))
+	{
+		const FSimplePhysicsInputRecord Record = InputRecording.Records[ReplayRecordIndex++];
+
+		if (Record.Type == ESimplePhysicsInputType::Frame)
+		{
+			return Record.Scalar;
+		}
+
+		if (Record.Type == ESimplePhysicsInputType::SetStaticColliders)
+		{
+			if (InputRecording.StaticColliderSets.IsValidIndex(Record.BodyId))
+			{
+				SetStaticColliders(InputRecording.StaticColliderSets[Record.BodyId], TArray<AActor*>());
+			}
+
+			continue;
+		}
+
+		if (Record.Type == ESimplePhysicsInputType::SetSimulationBounds)
+		{
+			if (InputRecording.SimulationBounds.IsValidIndex(Record.BodyId))
+			{
+				SetSimulationBounds(InputRecording.SimulationBounds[Record.BodyId]);
+			}
+
+			continue;
+		}
+
+		if (Record.Type == ESimplePhysicsInputType::AddBody)
+		{
+			// Bodies are matched by path, game code is expected to create the same RigidBodies as the recorded session
+			USimplePhysicsRigidBodyComponent* RigidBody = InputRecording.BodyPaths.IsValidIndex(Record.BodyId) ? FindObject<USimplePhysicsRigidBodyComponent>(GetWorld(), *InputRecording.BodyPaths[Record.BodyId]) : nullptr;
+			const int32 BodyIndex = FindOrAddBody(RigidBody);
+			if (BodyIndex != INDEX_NONE)
+			{
+				ReplayBodies.Add(Record.BodyId, Bodies.GetHandle(BodyIndex));
+			}
+			else
+			{
+				UE_LOG(LogTemp, Warning, TEXT("SimplePhysics replay could not find RigidBody %s"), InputRecording.BodyPaths.IsValidIndex(Record.BodyId) ? *InputRecording.BodyPaths[Record.BodyId] : TEXT("None"));
+			}
+
+			continue;
+		}
+
+		const FSimplePhysicsBodyHandle* Handle = ReplayBodies.Find(Record.BodyId);
+		const int32 BodyIndex = Handle ? Bodies.FindIndex(*Handle) : INDEX_NONE;
+		if (!Bodies.IsValidIndex(BodyIndex))
+		{
+			continue;
+		}
+
+		USimplePhysicsRigidBodyComponent* RigidBody = Bodies.Components[BodyIndex];
+
+		switch (Record.Type)
+		{
+		case ESimplePhysicsInputType::RemoveBody:
+			ReplayBodies.Remove(Record.BodyId);
+			break;
+
+		case ESimplePhysicsInputType::SetSimulationEnabled:
+			if (Record.Scalar > 0.f && RigidBody->UpdatedComponent)
+			{
+				// Start from the recorded location, game code placing the body is not replayed
+				RigidBody->UpdatedComponent->SetWorldLocation(Record.Value, false, nullptr, ETeleportType::TeleportPhysics);
+			}
+
+			SetSimulationEnabled(RigidBody, Record.Scalar > 0.f);
+			break;
+
+		case ESimplePhysicsInputType::WakeBody:
+			WakeRigidBody(RigidBody);
+			break;
+
+		case ESimplePhysicsInputType::RefreshBody:
+			RefreshRigidBody(RigidBody);
+			break;
+
+		case ESimplePhysicsInputType::AddForce:
+			AddForce(RigidBody, Record.Value);
+			break;
+
+		case ESimplePhysicsInputType::AddTorque:
+			AddTorque(RigidBody, Record.Value);
+			break;
+
+		case ESimplePhysicsInputType::SetVelocity:
+			SetVelocity(RigidBody, Record.Value);
+			break;
+
+		case ESimplePhysicsInputType::SetAngularVelocity:
+			SetAngularVelocity(RigidBody, Record.Value);
+			break;
+
+		case ESimplePhysicsInputType::AddImpulse:
+			AddImpulse(RigidBody, Record.Value, Record.Scalar > 0.f);
+			break;
+
+		case ESimplePhysicsInputType::SetIgnoreGroup:
+			SetIgnoreGroup(RigidBody, FMath::RoundToInt(Record.Value.X), Record.Scalar);
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("SimplePhysics finished replaying %s"), *InputRecordingFilename);
+	InputMode = EInputMode::None;
+	InputRecording.Reset();
+	ReplayBodies.Reset();
+
+	if (FParse::Param(FCommandLine::Get(), TEXT("SimplePhysicsReplayExit")))
+	{
+		FPlatformMisc::RequestExit(false);
 	}
+
+	return DeltaTime;
 }
 
 
@@ -45,256 +445,2343 @@ void USimplePhysicsSolver::SetSimulationEnabled(AActor* Actor, bool Enabled)
 
 bool USimplePhysicsSolver::IsSimulating(const USimplePhysicsRigidBodyComponent* RigidBody) const
 {
-	return SimulatedRigidBodies.Contains(RigidBody) || AddRigidBodies.Contains(RigidBody);
-}
+	if (!RigidBody)
+	{
+		return false;
+	}
 
+	const int32 BodyIndex = Bodies.FindIndex(RigidBody);
+	if (!Bodies.IsValidIndex(BodyIndex))
+	{
+		return false;
+	}
 
-void USimplePhysicsSolver::SetSimulationEnabled(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody, bool Enabled)
-{
-	if (Enabled)
+	switch (Bodies.PendingSimulation[BodyIndex])
 	{
-		AddRigidBodies.AddUnique(RigidBody);
+	case ESimplePhysicsPendingSimulation::Enable:
+		return true;
+
+	case ESimplePhysicsPendingSimulation::Disable:
+		return false;
+
+	default:
+		return Bodies.Simulating[BodyIndex] || Bodies.Sleeping[BodyIndex];
 	}
-	else
+}
+
+
+bool USimplePhysicsSolver::IsSleeping(const USimplePhysicsRigidBodyComponent* RigidBody) const
+{
+	const int32 BodyIndex = Bodies.FindIndex(RigidBody);
+	return Bodies.IsValidIndex(BodyIndex) && Bodies.Sleeping[BodyIndex];
+}
+
+
+const FHitResult* USimplePhysicsSolver::FindLastHitResult(const USimplePhysicsRigidBodyComponent* RigidBody) const
+{
+	return RigidBody ? LastHitResults.Find(RigidBody->GetBodyHandle()) : nullptr;
+}
+
+
+void USimplePhysicsSolver::ClearLastHitResult(const USimplePhysicsRigidBodyComponent* RigidBody)
+{
+	if (RigidBody)
 	{
-		InvalidRigidBodies.AddUnique(RigidBody);
+		LastHitResults.Remove(RigidBody->GetBodyHandle());
 	}
 }
 
 
-bool USimplePhysicsSolver::IsTickable() const
+USimplePhysicsRigidBodyComponent* USimplePhysicsSolver::GetRigidBody(const FSimplePhysicsBodyHandle& Handle) const
 {
-	return SimulatedRigidBodies.Num() > 0 || AddRigidBodies.Num() > 0 || InvalidRigidBodies.Num() > 0;
+	const int32 BodyIndex = Bodies.FindIndex(Handle);
+	return BodyIndex != INDEX_NONE ? Bodies.Components[BodyIndex].Get() : nullptr;
 }
 
 
-void USimplePhysicsSolver::Tick(float DeltaTime)
+bool USimplePhysicsSolver::RayCast(const FVector& Start, const FVector& End, FSimplePhysicsQueryHit& OutHit, uint32 CollisionMask)
 {
-	Super::Tick(DeltaTime);
+	return SphereSweep(Start, End, 0.f, OutHit, CollisionMask);
+}
 
-	// Ensure SimulatedRigidBodies is current before applying movement logic. 
-	RegisterRigidBodies();
 
-	QUICK_SCOPE_CYCLE_COUNTER(STAT_SimplePhysicsSolver_TickComponent);
-	ValidateRigidBodyTick(DeltaTime);
+bool USimplePhysicsSolver::SphereSweep(const FVector& Start, const FVector& End, float Radius, FSimplePhysicsQueryHit& OutHit, uint32 CollisionMask)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SimplePhysics_Query);
+	UpdateQueryIndex();
+	++Stats.NumQueries;
+	INC_DWORD_STAT(STAT_SimplePhysics_Queries);
+
+	return RunSweepQuery(FSimplePhysicsSweepQuery(Start, End, Radius, CollisionMask), QueryResults, OutHit);
 }
 
 
-void USimplePhysicsSolver::RegisterRigidBodies()
+int32 USimplePhysicsSolver::Overlap(const FVector& Center, float Radius, TArray<FSimplePhysicsBodyHandle>& OutBodies, uint32 CollisionMask)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SimplePhysics_Query);
+	UpdateQueryIndex();
+	++Stats.NumQueries;
+	INC_DWORD_STAT(STAT_SimplePhysics_Queries);
+
+	const int32 FirstBody = OutBodies.Num();
+	RunOverlapQuery(FSimplePhysicsOverlapQuery(Center, Radius, CollisionMask), QueryResults, OutBodies);
+
+	return OutBodies.Num() - FirstBody;
+}
+
+
+void USimplePhysicsSolver::SweepBatch(TConstArrayView<FSimplePhysicsSweepQuery> Queries, TArray<FSimplePhysicsQueryHit>& OutHits)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SimplePhysics_Query);
+	UpdateQueryIndex();
+	Stats.NumQueries += Queries.Num();
+	INC_DWORD_STAT_BY(STAT_SimplePhysics_Queries, Queries.Num());
+
+	OutHits.SetNum(Queries.Num());
+
+	// Queries only read the solver, each task keeps its own candidate list
+	TArray<TArray<int32>> TaskCandidates;
+	ParallelForWithTaskContext(TaskCandidates, Queries.Num(), [this, Queries, &OutHits](TArray<int32>& Candidates, int32 QueryIndex)
+	{
+		RunSweepQuery(Queries[QueryIndex], Candidates, OutHits[QueryIndex]);
+	},
+	Queries.Num() >= MIN_PARALLEL_QUERIES ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);
+}
+
+
+void USimplePhysicsSolver::OverlapBatch(TConstArrayView<FSimplePhysicsOverlapQuery> Queries, TArray<FSimplePhysicsBodyHandle>& OutBodies, TArray<int32>& OutQueryStarts)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SimplePhysics_Query);
+	UpdateQueryIndex();
+	Stats.NumQueries += Queries.Num();
+	INC_DWORD_STAT_BY(STAT_SimplePhysics_Queries, Queries.Num());
+
+	OutBodies.Reset();
+	OutQueryStarts.Reset(Queries.Num() + 1);
+
+	for (const FSimplePhysicsOverlapQuery& Query : Queries)
+	{
+		OutQueryStarts.Add(OutBodies.Num());
+		RunOverlapQuery(Query, QueryResults, OutBodies);
+	}
+
+	OutQueryStarts.Add(OutBodies.Num());
+}
+
+
+void USimplePhysicsSolver::UpdateQueryIndex()
 {
-	for (auto RigidBody : AddRigidBodies)
+	if (!bQueryIndexDirty)
 	{
-		SimulatedRigidBodies.AddUnique(RigidBody);
+		return;
 	}
 
-	for (auto RigidBody : InvalidRigidBodies)
+	bQueryIndexDirty = false;
+
+	float MaxRadius = 0.f;
+	for (int32 BodyIndex = 0; BodyIndex < Bodies.Num(); ++BodyIndex)
 	{
-		SimulatedRigidBodies.Remove(RigidBody);
+		if (Bodies.IsValidIndex(BodyIndex) && Bodies.CollisionEnabled[BodyIndex])
+		{
+			MaxRadius = FMath::Max(MaxRadius, Bodies.Radii[BodyIndex]);
+		}
 	}
 
-	AddRigidBodies.Empty();
-	InvalidRigidBodies.Empty();
+	QueryIndex.Reset(BroadphaseCellSize > 0.f ? BroadphaseCellSize : 2.f * MaxRadius);
+
+	for (int32 BodyIndex = 0; BodyIndex < Bodies.Num(); ++BodyIndex)
+	{
+		if (Bodies.IsValidIndex(BodyIndex) && Bodies.CollisionEnabled[BodyIndex] && Bodies.Radii[BodyIndex] > 0.f)
+		{
+			const FVector& Location = Bodies.Positions[BodyIndex];
+			const FVector Extent(Bodies.Radii[BodyIndex]);
+			QueryIndex.Insert(BodyIndex, FBox(Location - Extent, Location + Extent));
+		}
+	}
 }
 
 
-void USimplePhysicsSolver::ValidateRigidBodyTick(float DeltaTime)
+bool USimplePhysicsSolver::RunSweepQuery(const FSimplePhysicsSweepQuery& Query, TArray<int32>& Candidates, FSimplePhysicsQueryHit& OutHit) const
 {
-	InvalidRigidBodies.Empty();
-	RigidCollisionResultMap.Empty();
+	OutHit = FSimplePhysicsQueryHit();
+
+	if (QueryIndex.IsEmpty())
+	{
+		return false;
+	}
+
+	Candidates.Reset();
+	QueryIndex.QuerySegment(Query.Start, Query.End, Query.Radius, Candidates);
+
+	const FVector Move = Query.End - Query.Start;
+	const double MoveSizeSquared = Move.SizeSquared();
 
-	//UE_LOG(LogTemp, Warning, TEXT("Simulating Rigid Bodies:%d"), SimulatedRigidBodies.Num());
+	int32 HitBodyIndex = INDEX_NONE;
+	float HitTime = 1.f;
 
-	// Process movement for all SimulatedRigidBodies. If during the movement process the RigidBody
-	// becomes invalid add it to the InvalidRigidBodies list. These Rigidbodies will then be removed at the
-	// start of the next frame when RegisterRigidBodies() is called
-	for (auto RigidBody : SimulatedRigidBodies)
+	// Candidates are sorted, so ties go to the lowest body index
+	for (const int32 BodyIndex : Candidates)
 	{
-		if (!RigidBody || !IsValid(RigidBody->UpdatedComponent))
+		if (!Bodies.IsValidIndex(BodyIndex) || (Bodies.CollisionFilters[BodyIndex].CategoryBits & Query.CollisionMask) == 0)
 		{
-			InvalidRigidBodies.Add(RigidBody);
 			continue;
 		}
 
-		if (CanSimulateRigidBodyMovement(RigidBody, DeltaTime))
+		// Smallest Time in [0,1] where |Offset + Move * Time| = RadiusSum
+		const FVector Offset = Query.Start - Bodies.Positions[BodyIndex];
+		const float RadiusSum = Query.Radius + Bodies.Radii[BodyIndex];
+		const double C = Offset.SizeSquared() - FMath::Square(RadiusSum);
+
+		float Time = 0.f;
+		if (C > 0.0)
+		{
+			const double B = FVector::DotProduct(Offset, Move);
+			const double Discriminant = B * B - MoveSizeSquared * C;
+			if (MoveSizeSquared < UE_SMALL_NUMBER || B >= 0.0 || Discriminant < 0.0)
+			{
+				continue;
+			}
+
+			Time = static_cast<float>((-B - FMath::Sqrt(Discriminant)) / MoveSizeSquared);
+		}
+
+		if (Time <= 1.f && (HitBodyIndex == INDEX_NONE || Time < HitTime))
 		{
-			ApplyRigidBodyMovement(RigidBody, DeltaTime);
+			HitBodyIndex = BodyIndex;
+			HitTime = Time;
 		}
-		else
+	}
+
+	if (HitBodyIndex == INDEX_NONE)
+	{
+		return false;
+	}
+
+	const FVector& BodyLocation = Bodies.Positions[HitBodyIndex];
+	OutHit.Body = Bodies.GetHandle(HitBodyIndex);
+	OutHit.Time = HitTime;
+	OutHit.Location = Query.Start + Move * HitTime;
+
+	// A query starting at the center of the body has no direction to the surface, report the side it came from
+	const FVector Normal = (OutHit.Location - BodyLocation).GetSafeNormal();
+	OutHit.Normal = Normal.IsZero() ? -Move.GetSafeNormal() : Normal;
+	OutHit.ImpactPoint = BodyLocation + OutHit.Normal * Bodies.Radii[HitBodyIndex];
+
+	return true;
+}
+
+
+void USimplePhysicsSolver::RunOverlapQuery(const FSimplePhysicsOverlapQuery& Query, TArray<int32>& Candidates, TArray<FSimplePhysicsBodyHandle>& OutBodies) const
+{
+	if (QueryIndex.IsEmpty())
+	{
+		return;
+	}
+
+	Candidates.Reset();
+	QueryIndex.Query(FBox(Query.Center, Query.Center).ExpandBy(Query.Radius), Candidates);
+	Candidates.Sort();
+
+	for (const int32 BodyIndex : Candidates)
+	{
+		if (!Bodies.IsValidIndex(BodyIndex) || (Bodies.CollisionFilters[BodyIndex].CategoryBits & Query.CollisionMask) == 0)
+		{
+			continue;
+		}
+
+		if (FVector::DistSquared(Query.Center, Bodies.Positions[BodyIndex]) <= FMath::Square(Query.Radius + Bodies.Radii[BodyIndex]))
 		{
-			UE_LOG(LogTemp, Warning, TEXT("Invalid Simulating Rigid Bodies:%d"), SimulatedRigidBodies.Num());
-			InvalidRigidBodies.Add(RigidBody);
+			OutBodies.Add(Bodies.GetHandle(BodyIndex));
 		}
 	}
 }
 
 
-bool USimplePhysicsSolver::CanSimulateRigidBodyMovement(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody, float DeltaTime) const
+FSimplePhysicsMemoryFootprint USimplePhysicsSolver::GetMemoryFootprint() const
+{
+	FSimplePhysicsMemoryFootprint Footprint;
+	Footprint.NumBodies = Bodies.Num();
+	Footprint.ComponentBytes = USimplePhysicsRigidBodyComponent::StaticClass()->GetStructureSize();
+	Footprint.BodyStoreBytes = Bodies.GetAllocatedSize();
+	Footprint.SideTableBytes = LastHitResults.GetAllocatedSize() + ContactCache.GetAllocatedSize() + RestingContacts.GetAllocatedSize() + SavedBodyCollisions.GetAllocatedSize();
+	return Footprint;
+}
+
+
+void USimplePhysicsSolver::WakeRigidBody(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody)
+{
+	if (ShouldIgnoreInput())
+	{
+		return;
+	}
+
+	if (ShouldDeferInput())
+	{
+		DeferInput(ESimplePhysicsInputType::WakeBody, RigidBody);
+		return;
+	}
+
+	const int32 BodyIndex = Bodies.FindIndex(RigidBody);
+	if (Bodies.IsValidIndex(BodyIndex) && Bodies.Sleeping[BodyIndex])
+	{
+		RecordInput(ESimplePhysicsInputType::WakeBody, BodyIndex);
+		WakeIsland(BodyIndex);
+	}
+}
+
+
+void USimplePhysicsSolver::SetSimulationEnabled(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody, bool Enabled)
+{
+	if (ShouldIgnoreInput())
+	{
+		return;
+	}
+
+	if (ShouldDeferInput())
+	{
+		DeferInput(ESimplePhysicsInputType::SetSimulationEnabled, RigidBody, FVector::ZeroVector, Enabled ? 1.f : 0.f);
+		return;
+	}
+
+	const int32 BodyIndex = Enabled ? FindOrAddBody(RigidBody) : Bodies.FindIndex(RigidBody);
+	if (Bodies.IsValidIndex(BodyIndex))
+	{
+		const FVector Location = RigidBody->UpdatedComponent ? RigidBody->UpdatedComponent->GetComponentLocation() : FVector::ZeroVector;
+		RecordInput(ESimplePhysicsInputType::SetSimulationEnabled, BodyIndex, Location, Enabled ? 1.f : 0.f);
+
+		RequestSimulationChange(BodyIndex, Enabled ? ESimplePhysicsPendingSimulation::Enable : ESimplePhysicsPendingSimulation::Disable);
+	}
+}
+
+
+void USimplePhysicsSolver::RequestSimulationChange(int32 BodyIndex, ESimplePhysicsPendingSimulation Change)
+{
+	// Each body is queued once, the last request before the next step wins
+	if (Bodies.PendingSimulation[BodyIndex] == ESimplePhysicsPendingSimulation::None)
+	{
+		PendingSimulationChanges.Add(Bodies.GetHandle(BodyIndex));
+	}
+
+	Bodies.PendingSimulation[BodyIndex] = Change;
+	++BodyStateGeneration;
+}
+
+
+void USimplePhysicsSolver::AddRigidBody(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody)
+{
+	if (ShouldDeferInput())
+	{
+		DeferInput(ESimplePhysicsInputType::AddBody, RigidBody);
+		return;
+	}
+
+	if (FindOrAddBody(RigidBody) == INDEX_NONE)
+	{
+		return;
+	}
+
+	// RigidBody vs RigidBody contacts are found by the broadphase. Stop engine sweeps from reporting them as well.
+	// Only done here, bodies added implicitly by other inputs keep the collision game code gave them
+	UPrimitiveComponent* Primitive = RigidBody->UpdatedPrimitive;
+	if (Primitive && RigidBody->GetSphereComponent() && !SavedBodyCollisions.Contains(RigidBody))
+	{
+		FSimplePhysicsSavedCollision& SavedCollision = SavedBodyCollisions.Add(RigidBody);
+		SavedCollision.Primitive = Primitive;
+		SavedCollision.ObjectType = Primitive->GetCollisionObjectType();
+		SavedCollision.Response = Primitive->GetCollisionResponseToChannel(RigidBodyObjectType);
+
+		Primitive->SetCollisionObjectType(RigidBodyObjectType);
+		Primitive->SetCollisionResponseToChannel(RigidBodyObjectType, ECollisionResponse::ECR_Ignore);
+	}
+}
+
+
+int32 USimplePhysicsSolver::FindOrAddBody(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody)
+{
+	if (!IsValid(RigidBody))
+	{
+		return INDEX_NONE;
+	}
+
+	const int32 ExistingBodyIndex = Bodies.FindIndex(RigidBody);
+	if (ExistingBodyIndex != INDEX_NONE)
+	{
+		return ExistingBodyIndex;
+	}
+
+	const int32 BodyIndex = Bodies.Add(RigidBody);
+	++Stats.NumAdded;
+	++BodyStateGeneration;
+	bQueryIndexDirty = true;
+
+	return BodyIndex;
+}
+
+
+void USimplePhysicsSolver::RemoveRigidBody(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody)
+{
+	// The component may be destroyed before the next frame, so removal can not be deferred
+	if (ShouldDeferInput())
+	{
+		CompleteAsyncStage();
+	}
+
+	const int32 BodyIndex = Bodies.FindIndex(RigidBody);
+	if (Bodies.IsValidIndex(BodyIndex))
+	{
+		RecordInput(ESimplePhysicsInputType::RemoveBody, BodyIndex);
+		++Stats.NumRemoved;
+		RestingContacts.Remove(Bodies.GetHandle(BodyIndex));
+		LastHitResults.Remove(Bodies.GetHandle(BodyIndex));
+		SetBodySleeping(BodyIndex, false);
+		Bodies.Remove(BodyIndex);
+		++BodyStateGeneration;
+	}
+
+	// The primitive may be reused by game code, for example when its actor goes back to a pool
+	FSimplePhysicsSavedCollision SavedCollision;
+	if (SavedBodyCollisions.RemoveAndCopyValue(RigidBody, SavedCollision))
+	{
+		if (UPrimitiveComponent* Primitive = SavedCollision.Primitive.Get())
+		{
+			Primitive->SetCollisionObjectType(SavedCollision.ObjectType);
+			Primitive->SetCollisionResponseToChannel(RigidBodyObjectType, SavedCollision.Response);
+		}
+	}
+}
+
+
+void USimplePhysicsSolver::RefreshRigidBody(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody)
+{
+	if (ShouldIgnoreInput())
+	{
+		return;
+	}
+
+	if (ShouldDeferInput())
+	{
+		DeferInput(ESimplePhysicsInputType::RefreshBody, RigidBody);
+		return;
+	}
+
+	const int32 BodyIndex = FindOrAddBody(RigidBody);
+	if (BodyIndex != INDEX_NONE)
+	{
+		RecordInput(ESimplePhysicsInputType::RefreshBody, BodyIndex);
+		Bodies.RefreshParams(BodyIndex);
+		Bodies.ReadComponentState(BodyIndex);
+		++BodyStateGeneration;
+	}
+}
+
+
+void USimplePhysicsSolver::AddForce(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody, const FVector& Force)
+{
+	if (ShouldIgnoreInput())
+	{
+		return;
+	}
+
+	if (ShouldDeferInput())
+	{
+		DeferInput(ESimplePhysicsInputType::AddForce, RigidBody, Force);
+		return;
+	}
+
+	const int32 BodyIndex = FindOrAddBody(RigidBody);
+	if (BodyIndex != INDEX_NONE)
+	{
+		RecordInput(ESimplePhysicsInputType::AddForce, BodyIndex, Force);
+		Bodies.PendingForces[BodyIndex] += Force;
+		++BodyStateGeneration;
+	}
+}
+
+
+void USimplePhysicsSolver::AddTorque(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody, const FVector& Torque)
+{
+	if (ShouldIgnoreInput())
+	{
+		return;
+	}
+
+	if (ShouldDeferInput())
+	{
+		DeferInput(ESimplePhysicsInputType::AddTorque, RigidBody, Torque);
+		return;
+	}
+
+	const int32 BodyIndex = FindOrAddBody(RigidBody);
+	if (BodyIndex != INDEX_NONE)
+	{
+		RecordInput(ESimplePhysicsInputType::AddTorque, BodyIndex, Torque);
+		Bodies.PendingTorques[BodyIndex] += Torque;
+		++BodyStateGeneration;
+	}
+}
+
+
+void USimplePhysicsSolver::SetVelocity(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody, const FVector& NewVelocity)
+{
+	if (ShouldIgnoreInput())
+	{
+		return;
+	}
+
+	if (ShouldDeferInput())
+	{
+		DeferInput(ESimplePhysicsInputType::SetVelocity, RigidBody, NewVelocity);
+		return;
+	}
+
+	const int32 BodyIndex = FindOrAddBody(RigidBody);
+	if (BodyIndex != INDEX_NONE)
+	{
+		RecordInput(ESimplePhysicsInputType::SetVelocity, BodyIndex, NewVelocity);
+		Bodies.SetVelocity(BodyIndex, NewVelocity);
+		++BodyStateGeneration;
+	}
+}
+
+
+void USimplePhysicsSolver::SetAngularVelocity(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody, const FVector& NewAngularVelocity)
+{
+	if (ShouldIgnoreInput())
+	{
+		return;
+	}
+
+	if (ShouldDeferInput())
+	{
+		DeferInput(ESimplePhysicsInputType::SetAngularVelocity, RigidBody, NewAngularVelocity);
+		return;
+	}
+
+	const int32 BodyIndex = FindOrAddBody(RigidBody);
+	if (BodyIndex != INDEX_NONE)
+	{
+		RecordInput(ESimplePhysicsInputType::SetAngularVelocity, BodyIndex, NewAngularVelocity);
+		Bodies.SetAngularVelocity(BodyIndex, NewAngularVelocity);
+		++BodyStateGeneration;
+	}
+}
+
+
+void USimplePhysicsSolver::AddImpulse(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody, const FVector& Impulse, bool bVelocityChange)
+{
+	if (ShouldIgnoreInput())
+	{
+		return;
+	}
+
+	if (ShouldDeferInput())
+	{
+		DeferInput(ESimplePhysicsInputType::AddImpulse, RigidBody, Impulse, bVelocityChange ? 1.f : 0.f);
+		return;
+	}
+
+	const int32 BodyIndex = FindOrAddBody(RigidBody);
+	if (BodyIndex != INDEX_NONE)
+	{
+		ApplyBodyImpulse(BodyIndex, Impulse, bVelocityChange);
+	}
+}
+
+
+int32 USimplePhysicsSolver::ApplyRadialImpulse(const FVector& Origin, float Radius, float Strength, ERadialImpulseFalloff Falloff, bool bVelocityChange, uint32 CollisionMask)
+{
+	if (ShouldIgnoreInput() || Radius <= 0.f)
+	{
+		return 0;
+	}
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_SimplePhysics_Query);
+		UpdateQueryIndex();
+		++Stats.NumQueries;
+		INC_DWORD_STAT(STAT_SimplePhysics_Queries);
+
+		RadialImpulseBodies.Reset();
+		RunOverlapQuery(FSimplePhysicsOverlapQuery(Origin, Radius, CollisionMask), QueryResults, RadialImpulseBodies);
+	}
+
+	// Compute every impulse before applying any, waking a body reads its location again from the component
+	RadialImpulseIndices.Reset();
+	RadialImpulses.Reset();
+	for (const FSimplePhysicsBodyHandle& Handle : RadialImpulseBodies)
+	{
+		const int32 BodyIndex = Bodies.FindIndex(Handle);
+		if (!Bodies.Simulating[BodyIndex] && !Bodies.Sleeping[BodyIndex])
+		{
+			continue;
+		}
+
+		const FVector Offset = Bodies.Positions[BodyIndex] - Origin;
+		const float Distance = FMath::Max(Offset.Size() - Bodies.Radii[BodyIndex], 0.f);
+		const float Scale = (Falloff == RIF_Linear) ? 1.f - Distance / Radius : 1.f;
+
+		// Bodies centered on Origin have no direction to be pushed in, as with engine radial impulses
+		if (Scale > 0.f && !Offset.IsNearlyZero())
+		{
+			RadialImpulseIndices.Add(BodyIndex);
+			RadialImpulses.Add(Offset.GetUnsafeNormal() * (Strength * Scale));
+		}
+	}
+
+	const bool bDefer = ShouldDeferInput();
+	for (int32 Index = 0; Index < RadialImpulseIndices.Num(); ++Index)
+	{
+		const int32 BodyIndex = RadialImpulseIndices[Index];
+		if (bDefer)
+		{
+			DeferInput(ESimplePhysicsInputType::AddImpulse, Bodies.Components[BodyIndex], RadialImpulses[Index], bVelocityChange ? 1.f : 0.f);
+		}
+		else
+		{
+			ApplyBodyImpulse(BodyIndex, RadialImpulses[Index], bVelocityChange);
+		}
+	}
+
+	return RadialImpulseIndices.Num();
+}
+
+
+void USimplePhysicsSolver::ApplyBodyImpulse(int32 BodyIndex, const FVector& Impulse, bool bVelocityChange)
+{
+	RecordInput(ESimplePhysicsInputType::AddImpulse, BodyIndex, Impulse, bVelocityChange ? 1.f : 0.f);
+
+	if (Bodies.Sleeping[BodyIndex])
+	{
+		WakeBody(BodyIndex);
+	}
+
+	const FVector VelocityChange = bVelocityChange ? Impulse : Impulse * Bodies.InverseMasses[BodyIndex];
+	Bodies.SetVelocity(BodyIndex, Bodies.Velocities[BodyIndex] + VelocityChange);
+	++BodyStateGeneration;
+}
+
+
+void USimplePhysicsSolver::SetIgnoreGroup(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody, int32 GroupId, float Duration)
+{
+	if (ShouldIgnoreInput())
+	{
+		return;
+	}
+
+	if (ShouldDeferInput())
+	{
+		DeferInput(ESimplePhysicsInputType::SetIgnoreGroup, RigidBody, FVector(GroupId, 0.f, 0.f), Duration);
+		return;
+	}
+
+	const int32 BodyIndex = FindOrAddBody(RigidBody);
+	if (BodyIndex != INDEX_NONE)
+	{
+		RecordInput(ESimplePhysicsInputType::SetIgnoreGroup, BodyIndex, FVector(GroupId, 0.f, 0.f), Duration);
+		Bodies.CollisionFilters[BodyIndex].IgnoreGroup = GroupId;
+		Bodies.CollisionFilters[BodyIndex].IgnoreGroupEndTime = SimulationTime + Duration;
+		++BodyStateGeneration;
+	}
+}
+
+
+void USimplePhysicsSolver::SetStaticColliders(const FSimplePhysicsStaticColliderSet& InStaticColliders, const TArray<AActor*>& ColliderActors)
+{
+	if (ShouldIgnoreInput())
+	{
+		return;
+	}
+
+	// Rare and not tied to a body, so wait for the async stage instead of deferring
+	if (ShouldDeferInput())
+	{
+		CompleteAsyncStage();
+	}
+
+	if (IsRecordingInput())
+	{
+		InputRecording.Records.Emplace(ESimplePhysicsInputType::SetStaticColliders, InputRecording.StaticColliderSets.Add(InStaticColliders));
+	}
+
+	StaticColliders = InStaticColliders;
+
+	// The colliders usually enclose the room bodies play in
+	if (!StaticColliders.IsEmpty())
+	{
+		SimulationBounds = StaticColliders.GetBounds();
+	}
+
+	RestoreStaticColliderPrimitives();
+
+	for (AActor* ColliderActor : ColliderActors)
+	{
+		if (!IsValid(ColliderActor))
+		{
+			continue;
+		}
+
+		TInlineComponentArray<UPrimitiveComponent*> Primitives(ColliderActor);
+		for (UPrimitiveComponent* Primitive : Primitives)
+		{
+			FSimplePhysicsSavedCollision& SavedCollision = StaticColliderPrimitives.AddDefaulted_GetRef();
+			SavedCollision.Primitive = Primitive;
+			SavedCollision.ObjectType = Primitive->GetCollisionObjectType();
+			SavedCollision.Response = Primitive->GetCollisionResponseToChannel(RigidBodyObjectType);
+
+			Primitive->SetCollisionResponseToChannel(RigidBodyObjectType, ECollisionResponse::ECR_Ignore);
+		}
+	}
+}
+
+
+void USimplePhysicsSolver::ClearStaticColliders()
+{
+	if (ShouldIgnoreInput())
+	{
+		return;
+	}
+
+	if (ShouldDeferInput())
+	{
+		CompleteAsyncStage();
+	}
+
+	if (IsRecordingInput())
+	{
+		InputRecording.Records.Emplace(ESimplePhysicsInputType::SetStaticColliders, InputRecording.StaticColliderSets.Add(FSimplePhysicsStaticColliderSet()));
+	}
+
+	StaticColliders.Reset();
+	RestoreStaticColliderPrimitives();
+
+	// Recorded separately, so replays also lose the bounds
+	SetSimulationBounds(FBox(ForceInit));
+}
+
+
+void USimplePhysicsSolver::RestoreStaticColliderPrimitives()
+{
+	for (const FSimplePhysicsSavedCollision& SavedCollision : StaticColliderPrimitives)
+	{
+		if (UPrimitiveComponent* Primitive = SavedCollision.Primitive.Get())
+		{
+			Primitive->SetCollisionResponseToChannel(RigidBodyObjectType, SavedCollision.Response);
+		}
+	}
+
+	StaticColliderPrimitives.Reset();
+}
+
+
+void USimplePhysicsSolver::SetSimulationBounds(const FBox& Bounds)
+{
+	if (ShouldIgnoreInput())
+	{
+		return;
+	}
+
+	if (ShouldDeferInput())
+	{
+		CompleteAsyncStage();
+	}
+
+	if (IsRecordingInput())
+	{
+		InputRecording.Records.Emplace(ESimplePhysicsInputType::SetSimulationBounds, InputRecording.SimulationBounds.Add(Bounds));
+	}
+
+	SimulationBounds = Bounds;
+}
+
+
+bool USimplePhysicsSolver::FindStaticHit(int32 BodyIndex, const FVector& MoveDelta, FHitResult& OutHit) const
+{
+	// Bodies game code set to no collision pass through the room like they pass through everything else
+	const float Radius = Bodies.Radii[BodyIndex];
+	if (StaticColliders.IsEmpty() || Radius <= 0.f || !Bodies.CollisionEnabled[BodyIndex])
+	{
+		return false;
+	}
+
+	return StaticColliders.SweepSphere(Bodies.Positions[BodyIndex], MoveDelta, Radius, OutHit);
+}
+
+
+void USimplePhysicsSolver::SetBodyMovementData(int32 BodyIndex, const FMovementData& MovementData)
+{
+	Bodies.SetMovementData(BodyIndex, MovementData);
+	Bodies.WriteComponentState(BodyIndex);
+}
+
+
+bool USimplePhysicsSolver::IsTickable() const
+{
+	return Bodies.GetNumSimulating() > 0 || PendingSimulationChanges.Num() > 0 || InterpolatedBodies.Num() > 0 || IsReplayingInput() || AsyncStageTask.IsValid();
+}
+
+
+void USimplePhysicsSolver::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SimplePhysics_Tick);
+	Super::Tick(DeltaTime);
+
+	const FSimplePhysicsSolverStats FrameStartStats = Stats;
+
+	CompleteAsyncStage();
+
+	if (IsReplayingInput())
+	{
+		DeltaTime = ReplayInputs(DeltaTime);
+	}
+	else if (IsRecordingInput())
+	{
+		InputRecording.Records.Emplace(ESimplePhysicsInputType::Frame, INDEX_NONE, FVector::ZeroVector, DeltaTime);
+	}
+
+	if (bUseFixedTimestep)
+	{
+		StepFixedTimestep(DeltaTime);
+	}
+	else
+	{
+		StepSimulation(DeltaTime);
+	}
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_SimplePhysics_DispatchEvents);
+		DispatchBounceEvents();
+		DispatchEscapeEvents();
+	}
+
+	ReportFrameStats(FrameStartStats);
+
+	if (bUseFrameBudget)
+	{
+		UpdateQualityLevel(Stats.GetTotalSeconds() - FrameStartStats.GetTotalSeconds());
+	}
+
+	// Rates for the next frame, so they do not change between the async stage and the step it prepares
+	UpdateSignificance();
+
+	// Prepare the next step while the rest of the frame runs
+	LaunchAsyncStage();
+}
+
+
+void USimplePhysicsSolver::StepFixedTimestep(float DeltaTime)
+{
+	// Simulation always continues from the simulated locations, never the interpolated ones
+	RestoreInterpolatedTransforms();
+
+	StepAccumulator += DeltaTime;
+
+	int32 NumSteps = 0;
+	while (StepAccumulator >= FixedTimestep && NumSteps < MaxStepsPerFrame)
+	{
+		StepSimulation(FixedTimestep);
+		StepAccumulator -= FixedTimestep;
+		++NumSteps;
+	}
+
+	// Drop time that could not be simulated this frame
+	if (StepAccumulator >= FixedTimestep)
+	{
+		StepAccumulator = FMath::Fmod(StepAccumulator, FixedTimestep);
+	}
+
+	if (bInterpolateFixedSteps)
+	{
+		InterpolateTransforms(StepAccumulator / FixedTimestep);
+	}
+}
+
+
+void USimplePhysicsSolver::DeferInput(ESimplePhysicsInputType Type, USimplePhysicsRigidBodyComponent* RigidBody, const FVector& Value, float Scalar)
+{
+	if (IsValid(RigidBody))
+	{
+		DeferredInputs.Emplace(Type, RigidBody, Value, Scalar);
+	}
+}
+
+
+void USimplePhysicsSolver::ApplyDeferredInputs()
+{
+	TGuardValue<bool> ApplyingDeferredInputGuard(bApplyingDeferredInput, true);
+
+	for (int32 Index = 0; Index < DeferredInputs.Num(); ++Index)
+	{
+		const FSimplePhysicsDeferredInput Input = DeferredInputs[Index];
+		USimplePhysicsRigidBodyComponent* RigidBody = Input.RigidBody.Get();
+		if (!IsValid(RigidBody))
+		{
+			continue;
+		}
+
+		switch (Input.Type)
+		{
+		case ESimplePhysicsInputType::AddBody:
+			AddRigidBody(RigidBody);
+			break;
+
+		case ESimplePhysicsInputType::SetSimulationEnabled:
+			SetSimulationEnabled(RigidBody, Input.Scalar > 0.f);
+			break;
+
+		case ESimplePhysicsInputType::WakeBody:
+			WakeRigidBody(RigidBody);
+			break;
+
+		case ESimplePhysicsInputType::RefreshBody:
+			RefreshRigidBody(RigidBody);
+			break;
+
+		case ESimplePhysicsInputType::AddForce:
+			AddForce(RigidBody, Input.Value);
+			break;
+
+		case ESimplePhysicsInputType::AddTorque:
+			AddTorque(RigidBody, Input.Value);
+			break;
+
+		case ESimplePhysicsInputType::SetVelocity:
+			SetVelocity(RigidBody, Input.Value);
+			break;
+
+		case ESimplePhysicsInputType::SetAngularVelocity:
+			SetAngularVelocity(RigidBody, Input.Value);
+			break;
+
+		case ESimplePhysicsInputType::AddImpulse:
+			AddImpulse(RigidBody, Input.Value, Input.Scalar > 0.f);
+			break;
+
+		case ESimplePhysicsInputType::SetIgnoreGroup:
+			SetIgnoreGroup(RigidBody, FMath::RoundToInt(Input.Value.X), Input.Scalar);
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	DeferredInputs.Reset();
+}
+
+
+void USimplePhysicsSolver::LaunchAsyncStage()
+{
+	// The prepared step only matches a fixed step without substeps. Recorded and replayed sessions stay on the game thread
+	if (!bAsyncStepping || !bUseFixedTimestep || bUseSubstepping || InputMode != EInputMode::None)
+	{
+		return;
+	}
+
+	// Simulation changes are applied before the next step, and would drop the prepared step
+	if (Bodies.GetNumSimulating() == 0 || PendingSimulationChanges.Num() > 0)
+	{
+		return;
+	}
+
+	// The task only reads SleepingBroadphase, so it is rebuilt here
+	UpdateSleepingBroadphase();
+
+	AsyncStageTime = FixedTimestep;
+	AsyncStageStep = StepCount + 1;
+	AsyncStageGeneration = BodyStateGeneration;
+	AsyncStageTaskSeconds = 0.0;
+
+	// Only reads the body store and writes AsyncStageOutput. Inputs from game code are deferred or wait for the task
+	AsyncStageTask = UE::Tasks::Launch(TEXT("SimplePhysicsAsyncStage"), [this, StageStep = AsyncStageStep, StageTime = AsyncStageTime]()
+	{
+		FScopedDurationTimer StageTimer(AsyncStageTaskSeconds);
+		ScheduleBodies(StageStep, StageTime, AsyncStageOutput);
+		IntegrateBodies(AsyncStageOutput);
+		UpdateBroadphase(AsyncStageOutput);
+		GenerateContacts(AsyncStageOutput);
+	});
+}
+
+
+void USimplePhysicsSolver::CompleteAsyncStage()
+{
+	if (!AsyncStageTask.IsValid())
+	{
+		return;
+	}
+
+	AsyncStageTask.Wait();
+	AsyncStageTask = UE::Tasks::FTask();
+	Stats.AsyncStageSeconds += AsyncStageTaskSeconds;
+	bAsyncStageReady = true;
+
+	ApplyDeferredInputs();
+}
+
+
+bool USimplePhysicsSolver::ConsumeAsyncStage(float StepTime)
+{
+	if (!bAsyncStageReady)
+	{
+		return false;
+	}
+
+	bAsyncStageReady = false;
+
+	// Inputs, bodies moved by game code and bodies added or removed all bump BodyStateGeneration
+	const bool bValid = StepTime == AsyncStageTime && StepCount == AsyncStageStep && BodyStateGeneration == AsyncStageGeneration;
+
+	if (bValid)
+	{
+		// The replaced output is kept for its allocations, the next async stage overwrites it
+		Swap(StageOutput, AsyncStageOutput);
+		++Stats.NumAsyncStagesUsed;
+	}
+	else
+	{
+		++Stats.NumAsyncStagesDropped;
+	}
+
+	return bValid;
+}
+
+
+void USimplePhysicsSolver::ReportFrameStats(const FSimplePhysicsSolverStats& FrameStartStats) const
+{
+	const uint32 NumAdded = Stats.NumAdded - FrameStartStats.NumAdded;
+	const uint32 NumRemoved = Stats.NumRemoved - FrameStartStats.NumRemoved;
+	const uint32 NumContacts = Stats.NumContacts - FrameStartStats.NumContacts;
+	const uint32 NumIterations = Stats.NumIterations - FrameStartStats.NumIterations;
+	const uint32 NumAborts = Stats.NumAborts - FrameStartStats.NumAborts;
+	const uint32 NumSteps = Stats.NumSteps - FrameStartStats.NumSteps;
+
+	SET_DWORD_STAT(STAT_SimplePhysics_SimulatingBodies, Bodies.GetNumSimulating());
+	SET_DWORD_STAT(STAT_SimplePhysics_SleepingBodies, Bodies.GetNumSleeping());
+	SET_DWORD_STAT(STAT_SimplePhysics_AddedBodies, NumAdded);
+	SET_DWORD_STAT(STAT_SimplePhysics_RemovedBodies, NumRemoved);
+	SET_DWORD_STAT(STAT_SimplePhysics_Contacts, NumContacts);
+	SET_DWORD_STAT(STAT_SimplePhysics_Iterations, NumIterations);
+	SET_DWORD_STAT(STAT_SimplePhysics_Aborts, NumAborts);
+	SET_DWORD_STAT(STAT_SimplePhysics_Steps, NumSteps);
+	SET_DWORD_STAT(STAT_SimplePhysics_QualityLevel, QualityLevel);
+	SET_MEMORY_STAT(STAT_SimplePhysics_BodyStoreMemory, Bodies.GetAllocatedSize());
+	SET_MEMORY_STAT(STAT_SimplePhysics_SideTableMemory, LastHitResults.GetAllocatedSize() + ContactCache.GetAllocatedSize() + RestingContacts.GetAllocatedSize() + SavedBodyCollisions.GetAllocatedSize());
+
+	UE_TRACE_LOG(SimplePhysics, FrameStats, SimplePhysicsChannel)
+		<< FrameStats.Cycle(FPlatformTime::Cycles64())
+		<< FrameStats.SolverMilliseconds(static_cast<float>((Stats.GetTotalSeconds() - FrameStartStats.GetTotalSeconds()) * 1000.0))
+		<< FrameStats.Simulating(static_cast<uint32>(Bodies.GetNumSimulating()))
+		<< FrameStats.Sleeping(static_cast<uint32>(Bodies.GetNumSleeping()))
+		<< FrameStats.Added(NumAdded)
+		<< FrameStats.Removed(NumRemoved)
+		<< FrameStats.Contacts(NumContacts)
+		<< FrameStats.Iterations(NumIterations)
+		<< FrameStats.Aborts(NumAborts)
+		<< FrameStats.Steps(NumSteps)
+		<< FrameStats.QualityLevel(static_cast<uint32>(QualityLevel));
+}
+
+
+void USimplePhysicsSolver::UpdateQualityLevel(double FrameSeconds)
+{
+	const double FrameMilliseconds = FrameSeconds * 1000.0;
+	SmoothedFrameMilliseconds = FMath::Lerp(SmoothedFrameMilliseconds, FrameMilliseconds, static_cast<double>(QUALITY_COST_SMOOTHING));
+	++FramesAtQualityLevel;
+
+	if (SmoothedFrameMilliseconds < FrameBudgetMilliseconds * FrameBudgetRecoverFraction)
+	{
+		++FramesBelowRecoverBudget;
+	}
+	else
+	{
+		FramesBelowRecoverBudget = 0;
+	}
+
+	// Lower quality quickly so a burst of new bodies does not drop frames, but wait for the last change to show in the cost first
+	if (SmoothedFrameMilliseconds > FrameBudgetMilliseconds && FramesAtQualityLevel >= QUALITY_LOWER_FRAMES && QualityLevel < FrameBudgetQualityLevels - 1)
+	{
+		SetQualityLevel(QualityLevel + 1);
+	}
+	// Raise quality slowly, the gap between the recover fraction and the budget keeps the level from flipping every frame
+	else if (FramesBelowRecoverBudget >= FrameBudgetRecoverFrames && QualityLevel > 0)
+	{
+		SetQualityLevel(QualityLevel - 1);
+	}
+}
+
+
+void USimplePhysicsSolver::SetQualityLevel(int32 NewQualityLevel)
+{
+	QualityLevel = FMath::Clamp(NewQualityLevel, 0, FrameBudgetQualityLevels - 1);
+	FramesAtQualityLevel = 0;
+	FramesBelowRecoverBudget = 0;
+
+	const FSimplePhysicsQuality Quality = FullQuality.Lerp(LowestQuality, static_cast<float>(QualityLevel) / static_cast<float>(FrameBudgetQualityLevels - 1));
+	MaxSimulationIterations = Quality.MaxSimulationIterations;
+	ContactSolverIterations = Quality.ContactSolverIterations;
+	MaxSubsteps = Quality.MaxSubsteps;
+	MinimumSimulationVelocity = Quality.MinimumSimulationVelocity;
+}
+
+
+void USimplePhysicsSolver::StepSimulation(float DeltaTime)
+{
+	++Stats.NumSteps;
+	++StepCount;
+
+	// Bodies move and body indices change, scene queries after this see the new state
+	bQueryIndexDirty = true;
+
+	// Ensure the body store is current before applying movement logic. 
+	{
+		SCOPE_CYCLE_COUNTER(STAT_SimplePhysics_Register);
+		FScopedDurationTimer GatherTimer(Stats.GatherSeconds);
+		RegisterRigidBodies();
+		GatherBodyState();
+	}
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_SimplePhysics_Broadphase);
+		FScopedDurationTimer BroadphaseTimer(Stats.BroadphaseSeconds);
+		UpdateTeleportObstacles(DeltaTime);
+	}
+
+	PreviousPositions = Bodies.Positions;
+
+	const int32 NumSubsteps = bUseSubstepping ? ComputeNumSubsteps(DeltaTime) : 1;
+	const float SubstepTime = DeltaTime / NumSubsteps;
+
+	// Every substep of a step moves the same bodies
+	ScheduleBodies(StepCount, SubstepTime, StageOutput);
+
+	for (int32 Substep = 0; Substep < NumSubsteps; ++Substep)
+	{
+		// Bodies moved by the previous substep, or by gameplay code reacting to it
+		if (Substep > 0)
+		{
+			SCOPE_CYCLE_COUNTER(STAT_SimplePhysics_Register);
+			FScopedDurationTimer GatherTimer(Stats.GatherSeconds);
+			GatherBodyState();
+		}
+
+		StepBodies(SubstepTime);
+	}
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_SimplePhysics_Resolve);
+		FScopedDurationTimer ResolveTimer(Stats.SolveContactsSeconds);
+		FindOverlappingBodies();
+		DepenetrateStuckBodies();
+		FindEscapedBodies();
+	}
+
+	SimulationTime += DeltaTime;
+}
+
+
+int32 USimplePhysicsSolver::ComputeNumSubsteps(float StepTime) const
+{
+	float MaxSpeedSquared = 0.f;
+	float MinRadius = TNumericLimits<float>::Max();
+
+	for (int32 BodyIndex = 0; BodyIndex < Bodies.Num(); ++BodyIndex)
+	{
+		// Sleeping and stopped bodies do not move, so they should not make every other body take more substeps
+		if (!Bodies.CollisionEnabled[BodyIndex] || !Bodies.Simulating[BodyIndex] || Bodies.Sleeping[BodyIndex])
+		{
+			continue;
+		}
+
+		MinRadius = FMath::Min(MinRadius, Bodies.Radii[BodyIndex]);
+		MaxSpeedSquared = FMath::Max(MaxSpeedSquared, Bodies.Velocities[BodyIndex].SizeSquared());
+	}
+
+	if (MaxSpeedSquared <= 0.f || MinRadius == TNumericLimits<float>::Max())
+	{
+		return 1;
+	}
+
+	const float MaxTravel = FMath::Sqrt(MaxSpeedSquared) * StepTime;
+	const float AllowedTravel = MinRadius * SubstepMaxTravelFraction;
+
+	return FMath::Clamp(FMath::CeilToInt(MaxTravel / AllowedTravel), 1, MaxSubsteps);
+}
+
+
+void USimplePhysicsSolver::StepBodies(float DeltaTime)
+{
+	++Stats.NumSubsteps;
+
+	// Integrate -> Collide -> Move and write back. Integration and collision are free of engine calls, so they can be prepared by the async stage
+	if (!ConsumeAsyncStage(DeltaTime))
+	{
+		{
+			SCOPE_CYCLE_COUNTER(STAT_SimplePhysics_Integrate);
+			FScopedDurationTimer IntegrateTimer(Stats.IntegrateSeconds);
+			IntegrateBodies(StageOutput);
+		}
+
+		SCOPE_CYCLE_COUNTER(STAT_SimplePhysics_Collide);
+		FScopedDurationTimer BroadphaseTimer(Stats.BroadphaseSeconds);
+		UpdateSleepingBroadphase();
+		UpdateBroadphase(StageOutput);
+		GenerateContacts(StageOutput);
+	}
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_SimplePhysics_Resolve);
+		FScopedDurationTimer SolveContactsTimer(Stats.SolveContactsSeconds);
+		SolveContacts();
+		Stats.NumContacts += StageOutput.Contacts.Num();
+		Stats.NumRejectedPairs += StageOutput.NumRejectedPairs;
+	}
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_SimplePhysics_Sweep);
+		FScopedDurationTimer MoveTimer(Stats.MoveSeconds);
+		ValidateRigidBodyTick(DeltaTime);
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_SimplePhysics_Writeback);
+	FScopedDurationTimer WritebackTimer(Stats.WritebackSeconds);
+	WriteTeleportedBodies();
+	WriteBodyState();
+}
+
+
+void USimplePhysicsSolver::RegisterRigidBodies()
+{
+	// No body indices are held between steps, so removed bodies can be released now
+	if (Bodies.Compact())
+	{
+		bSleepingBroadphaseDirty = true;
+		++BodyStateGeneration;
+	}
+
+	// Handles stay valid through Compact(), removed bodies resolve to INDEX_NONE
+	for (const FSimplePhysicsBodyHandle& Handle : PendingSimulationChanges)
+	{
+		const int32 BodyIndex = Bodies.FindIndex(Handle);
+		if (!Bodies.IsValidIndex(BodyIndex))
+		{
+			continue;
+		}
+
+		if (Bodies.PendingSimulation[BodyIndex] == ESimplePhysicsPendingSimulation::Enable)
+		{
+			WakeBody(BodyIndex);
+		}
+		else if (Bodies.PendingSimulation[BodyIndex] == ESimplePhysicsPendingSimulation::Disable)
+		{
+			SetBodySleeping(BodyIndex, false);
+			Bodies.SetSimulating(BodyIndex, false);
+		}
+
+		Bodies.PendingSimulation[BodyIndex] = ESimplePhysicsPendingSimulation::None;
+	}
+
+	PendingSimulationChanges.Reset();
+}
+
+
+void USimplePhysicsSolver::RestoreInterpolatedTransforms()
+{
+	for (int32 Index = 0; Index < InterpolatedBodies.Num(); ++Index)
+	{
+		const int32 BodyIndex = InterpolatedBodies[Index];
+		if (!Bodies.IsValidIndex(BodyIndex))
+		{
+			continue;
+		}
+
+		USceneComponent* UpdatedComponent = Bodies.Components[BodyIndex]->UpdatedComponent;
+		if (IsValid(UpdatedComponent) && UpdatedComponent->GetComponentLocation().Equals(InterpolatedLocations[Index]))
+		{
+			UpdatedComponent->SetWorldLocation(Bodies.Positions[BodyIndex], false, nullptr, ETeleportType::TeleportPhysics);
+		}
+	}
+
+	InterpolatedBodies.Reset();
+	InterpolatedLocations.Reset();
+}
+
+
+void USimplePhysicsSolver::InterpolateTransforms(float Alpha)
+{
+	for (int32 BodyIndex = 0; BodyIndex < PreviousPositions.Num(); ++BodyIndex)
+	{
+		if (!Bodies.IsValidIndex(BodyIndex) || !Bodies.Simulating[BodyIndex])
+		{
+			continue;
+		}
+
+		USceneComponent* UpdatedComponent = Bodies.Components[BodyIndex]->UpdatedComponent;
+		if (!IsValid(UpdatedComponent))
+		{
+			continue;
+		}
+
+		// Positions are only current if nothing else moved the body since the last step
+		const FVector& Location = Bodies.Positions[BodyIndex];
+		if (!UpdatedComponent->GetComponentLocation().Equals(Location))
+		{
+			continue;
+		}
+
+		UpdatedComponent->SetWorldLocation(FMath::Lerp(PreviousPositions[BodyIndex], Location, Alpha), false, nullptr, ETeleportType::TeleportPhysics);
+
+		InterpolatedBodies.Add(BodyIndex);
+		InterpolatedLocations.Add(UpdatedComponent->GetComponentLocation());
+	}
+}
+
+
+void USimplePhysicsSolver::GatherBodyState()
+{
+	for (int32 BodyIndex = 0; BodyIndex < Bodies.Num(); ++BodyIndex)
+	{
+		if (!Bodies.IsValidIndex(BodyIndex))
+		{
+			continue;
+		}
+
+		// Game code moving a body drops the async stage
+		if (!Bodies.Sleeping[BodyIndex])
+		{
+			if (Bodies.ReadComponentState(BodyIndex))
+			{
+				++BodyStateGeneration;
+			}
+		}
+		// Sleeping bodies are woken when moved, but game code can turn off their collision without moving them, for example when destroying them
+		else if (Bodies.ReadCollisionState(BodyIndex))
+		{
+			bSleepingBroadphaseDirty = true;
+			++BodyStateGeneration;
+		}
+	}
+}
+
+
+void USimplePhysicsSolver::ScheduleBodies(int64 StepIndex, float SubstepTime, FSimplePhysicsStageOutput& Output) const
+{
+	Output.BodyStepTimes.SetNumUninitialized(Bodies.Num());
+
+	for (int32 BodyIndex = 0; BodyIndex < Bodies.Num(); ++BodyIndex)
+	{
+		const int64 Interval = Bodies.UpdateIntervals[BodyIndex];
+		const int64 StepsSinceUpdate = FMath::Max<int64>(StepIndex - Bodies.LastUpdateSteps[BodyIndex], 1);
+
+		// Bodies with the same interval are spread over the steps by their slot, which stays the same while the store is compacted.
+		// Free slots are reused first, so slots stay close to 0..Num. Bodies whose interval just changed catch up at once
+		const bool bDue = Interval <= 1 || StepsSinceUpdate >= Interval || (StepIndex + Bodies.BodySlots[BodyIndex]) % Interval == 0;
+		Output.BodyStepTimes[BodyIndex] = bDue ? SubstepTime * FMath::Min(StepsSinceUpdate, Interval) : 0.f;
+	}
+}
+
+
+void USimplePhysicsSolver::UpdateSignificance()
+{
+	if (!bUseSignificance)
+	{
+		return;
+	}
+
+	// The camera follows the HMD, so this is the player view in VR
+	const APlayerController* PlayerController = GetWorld() ? GetWorld()->GetFirstPlayerController() : nullptr;
+	const APlayerCameraManager* CameraManager = PlayerController ? PlayerController->PlayerCameraManager.Get() : nullptr;
+	if (!CameraManager)
+	{
+		return;
+	}
+
+	const FVector ViewLocation = CameraManager->GetCameraLocation();
+	const FVector ViewDirection = CameraManager->GetCameraRotation().Vector();
+
+	// The view frustum is approximated by a cone of the horizontal field of view
+	const float CosHalfFOV = FMath::Cos(FMath::DegreesToRadians(0.5f * CameraManager->GetFOVAngle()));
+
+	for (int32 BodyIndex = 0; BodyIndex < Bodies.Num(); ++BodyIndex)
+	{
+		if (!Bodies.Simulating[BodyIndex])
+		{
+			continue;
+		}
+
+		const FVector ToBody = Bodies.Positions[BodyIndex] - ViewLocation;
+		const float Distance = ToBody.Size();
+
+		uint8 Interval = 1;
+		if (Distance > SignificanceFullRateDistance)
+		{
+			Interval = (Distance > SignificanceHalfRateDistance) ? 4 : 2;
+
+			if (bReduceRateOutOfView && FVector::DotProduct(ToBody, ViewDirection) < Distance * CosHalfFOV)
+			{
+				Interval = FMath::Min<uint8>(Interval * 2, 4);
+			}
+		}
+
+		Bodies.UpdateIntervals[BodyIndex] = Interval;
+	}
+}
+
+
+void USimplePhysicsSolver::IntegrateBodies(FSimplePhysicsStageOutput& Output) const
+{
+	Output.SimulatingBodies.Reset();
+	Output.IntegrationResults.SetNumUninitialized(Bodies.Num());
+
+	for (int32 BodyIndex = 0; BodyIndex < Bodies.Num(); ++BodyIndex)
+	{
+		if (Bodies.Simulating[BodyIndex] && Output.BodyStepTimes[BodyIndex] > 0.f)
+		{
+			Output.SimulatingBodies.Add(BodyIndex);
+		}
+		else
+		{
+			Output.IntegrationResults[BodyIndex] = FSimplePhysicsIntegrationResult();
+		}
+	}
+
+	// Each task only reads the body store and writes the result of its own batch of bodies
+	const int32 BatchWidth = SimplePhysicsLanes::Width;
+	const int32 NumBatches = FMath::DivideAndRoundUp(Output.SimulatingBodies.Num(), BatchWidth);
+	const int32 MinBatchesPerTask = FMath::DivideAndRoundUp(ParallelIntegrationBatchSize, BatchWidth);
+	ParallelFor(TEXT("SimplePhysicsIntegrate"), NumBatches, MinBatchesPerTask, [this, &Output, BatchWidth](int32 BatchIndex)
+	{
+		const int32 BatchStart = BatchIndex * BatchWidth;
+		const int32 NumInBatch = FMath::Min(BatchWidth, Output.SimulatingBodies.Num() - BatchStart);
+		Bodies.IntegrateBatch(Output.SimulatingBodies.GetData() + BatchStart, NumInBatch, Output.BodyStepTimes.GetData(), Output.IntegrationResults.GetData());
+	},
+	bParallelIntegration ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);
+}
+
+
+void USimplePhysicsSolver::WriteBodyState()
+{
+	for (const int32 BodyIndex : StageOutput.SimulatingBodies)
+	{
+		if (Bodies.IsValidIndex(BodyIndex))
+		{
+			Bodies.WriteComponentState(BodyIndex);
+		}
+	}
+}
+
+
+bool USimplePhysicsSolver::CanTeleportBody(int32 BodyIndex, const FVector& MoveDelta) const
+{
+	// Without static colliders the room is only known to the engine sweep
+	if (!bTeleportContactFreeBodies || StaticColliders.IsEmpty() || Bodies.Radii[BodyIndex] <= 0.f)
+	{
+		return false;
+	}
+
+	// Bodies added while moving were not in the broadphase
+	if (!StageOutput.HasCandidatePairs.IsValidIndex(BodyIndex) || StageOutput.HasCandidatePairs[BodyIndex])
+	{
+		return false;
+	}
+
+	const FVector& Start = Bodies.Positions[BodyIndex];
+	const FVector End = Start + MoveDelta;
+	const FBox MoveBounds = FBox(Start.ComponentMin(End), Start.ComponentMax(End)).ExpandBy(Bodies.Radii[BodyIndex]);
+
+	for (const FBox& Obstacle : TeleportObstacles)
+	{
+		if (Obstacle.Intersect(MoveBounds))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+void USimplePhysicsSolver::UpdateTeleportObstacles(float DeltaTime)
+{
+	TeleportObstacles.Reset();
+
+	UWorld* World = GetWorld();
+	if (!bTeleportContactFreeBodies || StaticColliders.IsEmpty() || !World)
+	{
+		return;
+	}
+
+	// RigidBodies are found by the broadphase
+	FCollisionObjectQueryParams ObjectParams(FCollisionObjectQueryParams::InitType::AllObjects);
+	ObjectParams.RemoveObjectTypesToQuery(RigidBodyObjectType);
+
+	// Static collider primitives are tested analytically
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(SimplePhysicsTeleportObstacles));
+	for (const FSimplePhysicsSavedCollision& SavedCollision : StaticColliderPrimitives)
+	{
+		if (const UPrimitiveComponent* Primitive = SavedCollision.Primitive.Get())
+		{
+			QueryParams.AddIgnoredComponent(Primitive);
+		}
+	}
+
+	const FBox RoomBounds = StaticColliders.GetBounds();
+	TArray<FOverlapResult> Overlaps;
+	World->OverlapMultiByObjectType(Overlaps, RoomBounds.GetCenter(), FQuat::Identity, ObjectParams, FCollisionShape::MakeBox(RoomBounds.GetExtent()), QueryParams);
+
+	for (const FOverlapResult& Overlap : Overlaps)
+	{
+		const UPrimitiveComponent* Primitive = Overlap.GetComponent();
+		if (!Primitive || Primitive->GetCollisionResponseToChannel(RigidBodyObjectType) != ECollisionResponse::ECR_Block)
+		{
+			continue;
+		}
+
+		// Obstacles keep moving while the bodies move
+		const AActor* Owner = Primitive->GetOwner();
+		const float Travel = Owner ? Owner->GetVelocity().Size() * DeltaTime : 0.f;
+		TeleportObstacles.Add(Primitive->Bounds.GetBox().ExpandBy(Travel));
+	}
+}
+
+
+void USimplePhysicsSolver::WriteTeleportedBodies()
+{
+	for (const int32 BodyIndex : TeleportedBodies)
+	{
+		if (!Bodies.IsValidIndex(BodyIndex))
+		{
+			continue;
+		}
+
+		USceneComponent* UpdatedComponent = Bodies.Components[BodyIndex]->UpdatedComponent;
+		if (!IsValid(UpdatedComponent))
+		{
+			continue;
+		}
+
+		if (UpdatedComponent->GetAttachParent() && !UpdatedComponent->IsUsingAbsoluteLocation())
+		{
+			UpdatedComponent->SetWorldLocation(Bodies.Positions[BodyIndex], false, nullptr, ETeleportType::TeleportPhysics);
+		}
+		else
+		{
+			// Relative location is the world location, so the transform can be set without going through MoveComponent()
+			UpdatedComponent->SetRelativeLocation_Direct(Bodies.Positions[BodyIndex]);
+			UpdatedComponent->UpdateComponentToWorld(EUpdateTransformFlags::None, ETeleportType::TeleportPhysics);
+		}
+	}
+
+	TeleportedBodies.Reset();
+}
+
+
+void USimplePhysicsSolver::UpdateBroadphase(FSimplePhysicsStageOutput& Output) const
+{
+	Output.BroadphaseBodies.Reset();
+	Output.CandidatePairs.Reset();
+
+	// Sleeping bodies are kept in SleepingBroadphase, so they are not inserted again every tick
+	float MaxRadius = 0.f;
+	for (int32 BodyIndex = 0; BodyIndex < Bodies.Num(); ++BodyIndex)
+	{
+		if (!Bodies.CollisionEnabled[BodyIndex] || Bodies.Sleeping[BodyIndex])
+		{
+			continue;
+		}
+
+		Output.BroadphaseBodies.Add(BodyIndex);
+		MaxRadius = FMath::Max(MaxRadius, Bodies.Radii[BodyIndex]);
+	}
+
+	if (Output.BroadphaseBodies.Num() >= 2)
+	{
+		Output.Broadphase.Reset(BroadphaseCellSize > 0.f ? BroadphaseCellSize : 2.f * MaxRadius);
+	}
+
+	const bool bQuerySleeping = !SleepingBroadphase.IsEmpty();
+
+	for (const int32 BodyIndex : Output.BroadphaseBodies)
+	{
+		const FVector& Start = Bodies.Positions[BodyIndex];
+		const FVector End = Start + Output.IntegrationResults[BodyIndex].MoveDelta;
+		const FBox Bounds = FBox(Start.ComponentMin(End), Start.ComponentMax(End)).ExpandBy(Bodies.Radii[BodyIndex]);
+
+		if (Output.BroadphaseBodies.Num() >= 2)
+		{
+			Output.Broadphase.Insert(BodyIndex, Bounds);
+		}
+
+		// Only simulating bodies can wake a sleeping body
+		if (bQuerySleeping && Bodies.Simulating[BodyIndex])
+		{
+			Output.SleepingQueryResults.Reset();
+			SleepingBroadphase.Query(Bounds, Output.SleepingQueryResults);
+
+			for (const int32 SleepingBodyIndex : Output.SleepingQueryResults)
+			{
+				Output.CandidatePairs.Emplace(BodyIndex, SleepingBodyIndex);
+			}
+		}
+	}
+
+	if (Output.BroadphaseBodies.Num() >= 2)
+	{
+		Output.Broadphase.GatherCandidatePairs(Output.CandidatePairs);
+	}
+
+	// Reject filtered pairs before any contact work, fragments of the same parent spawn overlapping each other
+	const int32 NumUnfilteredPairs = Output.CandidatePairs.Num();
+	Output.CandidatePairs.RemoveAll([this](const FSimplePhysicsCandidatePair& Pair)
+	{
+		return !Bodies.ShouldCollide(Pair.First, Pair.Second, SimulationTime);
+	});
+	Output.NumRejectedPairs = NumUnfilteredPairs - Output.CandidatePairs.Num();
+}
+
+
+void USimplePhysicsSolver::UpdateSleepingBroadphase()
+{
+	if (!bSleepingBroadphaseDirty)
+	{
+		return;
+	}
+
+	bSleepingBroadphaseDirty = false;
+
+	float MaxRadius = 0.f;
+	for (int32 BodyIndex = 0; BodyIndex < Bodies.Num(); ++BodyIndex)
+	{
+		if (Bodies.Sleeping[BodyIndex] && Bodies.CollisionEnabled[BodyIndex])
+		{
+			MaxRadius = FMath::Max(MaxRadius, Bodies.Radii[BodyIndex]);
+		}
+	}
+
+	SleepingBroadphase.Reset(BroadphaseCellSize > 0.f ? BroadphaseCellSize : 2.f * MaxRadius);
+
+	for (int32 BodyIndex = 0; BodyIndex < Bodies.Num(); ++BodyIndex)
+	{
+		if (Bodies.Sleeping[BodyIndex] && Bodies.CollisionEnabled[BodyIndex])
+		{
+			const FVector& Location = Bodies.Positions[BodyIndex];
+			const FVector Extent(Bodies.Radii[BodyIndex]);
+			SleepingBroadphase.Insert(BodyIndex, FBox(Location - Extent, Location + Extent));
+		}
+	}
+}
+
+
+void USimplePhysicsSolver::GenerateContacts(FSimplePhysicsStageOutput& Output) const
+{
+	Output.Contacts.Reset();
+	Output.ContactTestBodies.Reset();
+	Output.ContactTestOtherBodies.Reset();
+	Output.HasCandidatePairs.Init(false, Bodies.Num());
+
+	for (const FSimplePhysicsCandidatePair& Pair : Output.CandidatePairs)
+	{
+		Output.HasCandidatePairs[Pair.First] = true;
+		Output.HasCandidatePairs[Pair.Second] = true;
+
+		const bool FirstSimulating = Bodies.Simulating[Pair.First];
+		if (!FirstSimulating && !Bodies.Simulating[Pair.Second])
+		{
+			continue;
+		}
+
+		// Collision logic is applied from the point of view of a simulating RigidBody
+		Output.ContactTestBodies.Add(FirstSimulating ? Pair.First : Pair.Second);
+		Output.ContactTestOtherBodies.Add(FirstSimulating ? Pair.Second : Pair.First);
+	}
+
+	for (int32 BatchStart = 0; BatchStart < Output.ContactTestBodies.Num(); BatchStart += SimplePhysicsLanes::Width)
+	{
+		const int32 NumPairs = FMath::Min(SimplePhysicsLanes::Width, Output.ContactTestBodies.Num() - BatchStart);
+
+		float TimesOfImpact[SimplePhysicsLanes::Width];
+		const int32 HitMask = ComputeSphereTimeOfImpactBatch(Output, Output.ContactTestBodies.GetData() + BatchStart, Output.ContactTestOtherBodies.GetData() + BatchStart, NumPairs, TimesOfImpact);
+
+		for (int32 Lane = 0; Lane < NumPairs; ++Lane)
+		{
+			if ((HitMask & (1 << Lane)) == 0)
+			{
+				continue;
+			}
+
+			const int32 BodyIndex = Output.ContactTestBodies[BatchStart + Lane];
+			const int32 OtherBodyIndex = Output.ContactTestOtherBodies[BatchStart + Lane];
+			const float TimeOfImpact = TimesOfImpact[Lane];
+
+			const FVector Location = Bodies.Positions[BodyIndex] + Output.IntegrationResults[BodyIndex].MoveDelta * TimeOfImpact;
+			const FVector OtherLocation = Bodies.Positions[OtherBodyIndex] + Output.IntegrationResults[OtherBodyIndex].MoveDelta * TimeOfImpact;
+			Output.Contacts.Emplace(BodyIndex, OtherBodyIndex, TimeOfImpact, (Location - OtherLocation).GetSafeNormal());
+		}
+	}
+
+	Output.Contacts.Sort();
+}
+
+
+void USimplePhysicsSolver::SolveContacts()
+{
+	TArray<FSimplePhysicsContact>& Contacts = StageOutput.Contacts;
+	ContactTimes.Init(1.f, Bodies.Num());
+	SolvedContacts.Reset();
+
+	// Wake bodies and handle contacts with bodies that do not respond, in time of impact order
+	for (int32 ContactIndex = 0; ContactIndex < Contacts.Num(); ++ContactIndex)
+	{
+		const FSimplePhysicsContact& Contact = Contacts[ContactIndex];
+		const int32 BodyIndex = Contact.BodyIndex;
+		const int32 OtherBodyIndex = Contact.OtherBodyIndex;
+
+		// A previous contact this tick can remove a body
+		if (!Bodies.IsValidIndex(BodyIndex) || !Bodies.IsValidIndex(OtherBodyIndex))
+		{
+			continue;
+		}
+
+		// Sleeping bodies still have simulation enabled and are always woken
+		const bool OtherRigidBodySimulating = Bodies.Simulating[OtherBodyIndex];
+		if (OtherRigidBodySimulating || Bodies.Sleeping[OtherBodyIndex] || Bodies.Params[OtherBodyIndex].bEnableSimulationOnRigidBodyCollision)
+		{
+			if (!OtherRigidBodySimulating)
+			{
+				WakeIsland(OtherBodyIndex);
+			}
+
+			Contacts[ContactIndex].bSolve = true;
+			SolvedContacts.Add(ContactIndex);
+		}
+		else
+		{
+			HandleImpact(BodyIndex, MakeContactHit(Contact), 0.f, FVector());
+		}
+
+		// Bodies move to the contact before continuing with their new velocity
+		if (ContactTimes[BodyIndex] == 1.f)
+		{
+			ContactTimes[BodyIndex] = Contact.Time;
+		}
+
+		if (ContactTimes[OtherBodyIndex] == 1.f && Contacts[ContactIndex].bSolve)
+		{
+			ContactTimes[OtherBodyIndex] = Contact.Time;
+		}
+	}
+
+	if (SolvedContacts.Num() == 0)
+	{
+		ContactCache.Reset();
+		return;
+	}
+
+	// Restitution targets use the velocities before any contact is solved
+	for (const int32 ContactIndex : SolvedContacts)
+	{
+		FSimplePhysicsContact& Contact = Contacts[ContactIndex];
+		if (!Bodies.IsValidIndex(Contact.BodyIndex) || !Bodies.IsValidIndex(Contact.OtherBodyIndex))
+		{
+			Contact.bSolve = false;
+			continue;
+		}
+
+		const FSimplePhysicsBodyParams& Params = Bodies.Params[Contact.BodyIndex];
+		const float Restitution = Params.GetRestitutionCoefficient(Bodies.Params[Contact.OtherBodyIndex]);
+		const float NormalVelocity = FVector::DotProduct(Bodies.Velocities[Contact.BodyIndex] - Bodies.Velocities[Contact.OtherBodyIndex], Contact.Normal);
+
+		Contact.TargetNormalVelocity = (NormalVelocity < 0.f) ? -Restitution * NormalVelocity : 0.f;
+		Contact.NormalImpulse = 0.f;
+	}
+
+	// Start pairs that touched last step from the impulse they needed then, so resting clusters converge in the first pass
+	if (bWarmStartContacts)
+	{
+		for (const int32 ContactIndex : SolvedContacts)
+		{
+			FSimplePhysicsContact& Contact = Contacts[ContactIndex];
+			if (!Contact.bSolve)
+			{
+				continue;
+			}
+
+			bool bFlipped;
+			const FSimplePhysicsCachedContact* CachedContact = ContactCache.Find(MakeContactCacheKey(Contact, bFlipped));
+			if (!CachedContact || FVector::DotProduct(bFlipped ? -CachedContact->Normal : CachedContact->Normal, Contact.Normal) < CONTACT_CACHE_MIN_NORMAL_DOT)
+			{
+				continue;
+			}
+
+			++Stats.NumWarmStartedContacts;
+			Contact.NormalImpulse = CachedContact->NormalImpulse * ContactWarmStartFactor;
+
+			const FVector Impulse = Contact.NormalImpulse * Contact.Normal;
+			Bodies.Velocities[Contact.BodyIndex] += Impulse * Bodies.InverseMasses[Contact.BodyIndex];
+			Bodies.Velocities[Contact.OtherBodyIndex] -= Impulse * Bodies.InverseMasses[Contact.OtherBodyIndex];
+		}
+	}
+
+	// Sequential impulses. Each pass pushes every contact towards its target, accumulated impulses are clamped so contacts never pull
+	for (int32 Iteration = 0; Iteration < ContactSolverIterations; ++Iteration)
+	{
+		++Stats.NumContactSolverPasses;
+		float MaxVelocityChange = 0.f;
+
+		for (const int32 ContactIndex : SolvedContacts)
+		{
+			FSimplePhysicsContact& Contact = Contacts[ContactIndex];
+			if (!Contact.bSolve)
+			{
+				continue;
+			}
+
+			const float InverseMass = Bodies.InverseMasses[Contact.BodyIndex];
+			const float OtherInverseMass = Bodies.InverseMasses[Contact.OtherBodyIndex];
+			const float InverseMassSum = InverseMass + OtherInverseMass;
+			if (InverseMassSum <= 0.f)
+			{
+				continue;
+			}
+
+			FVector& Velocity = Bodies.Velocities[Contact.BodyIndex];
+			FVector& OtherVelocity = Bodies.Velocities[Contact.OtherBodyIndex];
+			const float NormalVelocity = FVector::DotProduct(Velocity - OtherVelocity, Contact.Normal);
+
+			const float PreviousImpulse = Contact.NormalImpulse;
+			Contact.NormalImpulse = FMath::Max(PreviousImpulse + (Contact.TargetNormalVelocity - NormalVelocity) / InverseMassSum, 0.f);
+			const FVector Impulse = (Contact.NormalImpulse - PreviousImpulse) * Contact.Normal;
+
+			Velocity += Impulse * InverseMass;
+			OtherVelocity -= Impulse * OtherInverseMass;
+			MaxVelocityChange = FMath::Max(MaxVelocityChange, FMath::Abs(Contact.NormalImpulse - PreviousImpulse) * InverseMassSum);
+		}
+
+		if (MaxVelocityChange < CONTACT_CONVERGED_VELOCITY)
+		{
+			break;
+		}
+	}
+
+	ContactCache.Reset();
+
+	// Angular velocity is unchanged, the lever arm of a sphere contact is parallel to the normal
+	for (const int32 ContactIndex : SolvedContacts)
+	{
+		const FSimplePhysicsContact& Contact = Contacts[ContactIndex];
+		if (Contact.bSolve && Contact.NormalImpulse > 0.f)
+		{
+			if (bWarmStartContacts)
+			{
+				bool bFlipped;
+				const TPair<FSimplePhysicsBodyHandle, FSimplePhysicsBodyHandle> Key = MakeContactCacheKey(Contact, bFlipped);
+				ContactCache.Add(Key, FSimplePhysicsCachedContact(bFlipped ? -Contact.Normal : Contact.Normal, Contact.NormalImpulse));
+			}
+
+			// Apply velocity limits and copy the result to the components
+			Bodies.SetVelocity(Contact.BodyIndex, Bodies.Velocities[Contact.BodyIndex]);
+			Bodies.SetVelocity(Contact.OtherBodyIndex, Bodies.Velocities[Contact.OtherBodyIndex]);
+			Bodies.WriteComponentState(Contact.BodyIndex);
+			Bodies.WriteComponentState(Contact.OtherBodyIndex);
+		}
+	}
+}
+
+
+TPair<FSimplePhysicsBodyHandle, FSimplePhysicsBodyHandle> USimplePhysicsSolver::MakeContactCacheKey(const FSimplePhysicsContact& Contact, bool& bOutFlipped) const
+{
+	const FSimplePhysicsBodyHandle Handle = Bodies.GetHandle(Contact.BodyIndex);
+	const FSimplePhysicsBodyHandle OtherHandle = Bodies.GetHandle(Contact.OtherBodyIndex);
+
+	// Either body can be the one the contact was found from, so order by slot
+	bOutFlipped = OtherHandle.Slot < Handle.Slot;
+	return bOutFlipped ? MakeTuple(OtherHandle, Handle) : MakeTuple(Handle, OtherHandle);
+}
+
+
+FHitResult USimplePhysicsSolver::MakeContactHit(const FSimplePhysicsContact& Contact) const
+{
+	const FVector& Start = Bodies.Positions[Contact.BodyIndex];
+	const FVector& Move = StageOutput.IntegrationResults[Contact.BodyIndex].MoveDelta;
+	const FVector Location = Start + Move * Contact.Time;
+	const FVector OtherLocation = Bodies.Positions[Contact.OtherBodyIndex] + StageOutput.IntegrationResults[Contact.OtherBodyIndex].MoveDelta * Contact.Time;
+	const USimplePhysicsRigidBodyComponent* OtherRigidBody = Bodies.Components[Contact.OtherBodyIndex];
+
+	FHitResult Hit(Contact.Time);
+	Hit.bBlockingHit = true;
+	Hit.Location = Location;
+	Hit.ImpactPoint = OtherLocation + Contact.Normal * Bodies.Radii[Contact.OtherBodyIndex];
+	Hit.Normal = Contact.Normal;
+	Hit.ImpactNormal = Contact.Normal;
+	Hit.TraceStart = Start;
+	Hit.TraceEnd = Start + Move;
+	Hit.HitObjectHandle = FActorInstanceHandle(OtherRigidBody->GetOwner());
+	Hit.Component = OtherRigidBody->UpdatedPrimitive;
+	return Hit;
+}
+
+
+int32 USimplePhysicsSolver::ComputeSphereTimeOfImpactBatch(const FSimplePhysicsStageOutput& Output, const int32* BodyIndices, const int32* OtherBodyIndices, int32 NumPairs, float* OutTimes) const
+{
+	using namespace SimplePhysicsLanes;
+
+	// Pad the batch by repeating the last pair. Padded lanes are masked out of the result
+	int32 Indices[Width];
+	int32 OtherIndices[Width];
+	for (int32 Lane = 0; Lane < Width; ++Lane)
+	{
+		Indices[Lane] = BodyIndices[FMath::Min(Lane, NumPairs - 1)];
+		OtherIndices[Lane] = OtherBodyIndices[FMath::Min(Lane, NumPairs - 1)];
+	}
+
+	// Solve |RelativeStart + RelativeMove * t| = RadiusSum for the smallest t in [0,1]
+	const FVectorLanes RelativeStart = Subtract(LoadVectors(Bodies.Positions, Indices), LoadVectors(Bodies.Positions, OtherIndices));
+	const FVectorLanes RelativeMove = Subtract(
+		LoadVectors(Output.IntegrationResults, &FSimplePhysicsIntegrationResult::MoveDelta, Indices),
+		LoadVectors(Output.IntegrationResults, &FSimplePhysicsIntegrationResult::MoveDelta, OtherIndices));
+	const VectorRegister4Double RadiusSum = VectorAdd(Load(Bodies.Radii, Indices), Load(Bodies.Radii, OtherIndices));
+
+	const VectorRegister4Double B = Dot(RelativeStart, RelativeMove);
+	const VectorRegister4Double C = VectorSubtract(Dot(RelativeStart, RelativeStart), VectorMultiply(RadiusSum, RadiusSum));
+	const VectorRegister4Double A = Dot(RelativeMove, RelativeMove);
+	const VectorRegister4Double Discriminant = VectorSubtract(VectorMultiply(B, B), VectorMultiply(A, C));
+
+	// Spheres moving apart never touch. Spheres already touching and approaching touch at time 0
+	const VectorRegister4Double Approaching = VectorCompareGT(GlobalVectorConstants::DoubleZero, B);
+	const VectorRegister4Double Touching = VectorCompareGE(GlobalVectorConstants::DoubleZero, C);
+
+	const VectorRegister4Double SweepTime = VectorDivide(
+		VectorSubtract(VectorNegate(B), VectorSqrt(VectorMax(Discriminant, GlobalVectorConstants::DoubleZero))),
+		VectorMax(A, Splat(UE_SMALL_NUMBER)));
+	const VectorRegister4Double SweepHit = VectorBitwiseAnd(
+		VectorBitwiseAnd(VectorCompareGE(A, Splat(UE_SMALL_NUMBER)), VectorCompareGE(Discriminant, GlobalVectorConstants::DoubleZero)),
+		VectorCompareGE(GlobalVectorConstants::DoubleOne, SweepTime));
+
+	const VectorRegister4Double Hit = VectorBitwiseAnd(Approaching, VectorBitwiseOr(Touching, SweepHit));
+	const VectorRegister4Double Time = VectorSelect(Touching, GlobalVectorConstants::DoubleZero, VectorMax(SweepTime, GlobalVectorConstants::DoubleZero));
+
+	alignas(32) double Times[Width];
+	VectorStoreAligned(Time, Times);
+	for (int32 Lane = 0; Lane < NumPairs; ++Lane)
+	{
+		OutTimes[Lane] = static_cast<float>(Times[Lane]);
+	}
+
+	return VectorMaskBits(Hit) & ((1 << NumPairs) - 1);
+}
+
+
+void USimplePhysicsSolver::ValidateRigidBodyTick(float DeltaTime)
+{
+	// Process movement for all simulating bodies. If during the movement process the RigidBody
+	// becomes invalid request it to stop simulating. These Rigidbodies will then stop simulating at the
+	// start of the next frame when RegisterRigidBodies() is called. Bodies added while moving are appended
+	// to the store and will not be simulating yet.
+	for (int32 BodyIndex = 0; BodyIndex < Bodies.Num(); ++BodyIndex)
+	{
+		if (!Bodies.Simulating[BodyIndex])
+		{
+			continue;
+		}
+
+		USimplePhysicsRigidBodyComponent* RigidBody = Bodies.Components[BodyIndex];
+		if (!RigidBody || !IsValid(RigidBody->UpdatedComponent))
+		{
+			Bodies.SetSimulating(BodyIndex, false);
+			continue;
+		}
+
+		// Bodies with a reduced update rate wait for their turn, then move by all the time they waited
+		const float BodyTime = StageOutput.BodyStepTimes.IsValidIndex(BodyIndex) ? StageOutput.BodyStepTimes[BodyIndex] : DeltaTime;
+		if (BodyTime <= 0.f)
+		{
+			++Stats.NumSkippedMoves;
+			continue;
+		}
+
+		if (CanSimulateRigidBodyMovement(RigidBody, BodyTime))
+		{
+			ApplyRigidBodyMovement(BodyIndex, BodyTime);
+
+			if (Bodies.IsValidIndex(BodyIndex))
+			{
+				Bodies.LastUpdateSteps[BodyIndex] = StepCount;
+			}
+		}
+		else
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Invalid Simulating Rigid Bodies:%d"), Bodies.GetNumSimulating());
+			RequestSimulationChange(BodyIndex, ESimplePhysicsPendingSimulation::Disable);
+		}
+	}
+}
+
+
+bool USimplePhysicsSolver::CanSimulateRigidBodyMovement(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody, float DeltaTime) const
+{
+	return RigidBody && IsValid(RigidBody->UpdatedComponent) &&
+		   !RigidBody->ShouldSkipUpdate(DeltaTime) &&
+		   !RigidBody->UpdatedComponent->IsSimulatingPhysics();
+}
+
+
+void USimplePhysicsSolver::ApplyRigidBodyMovement(int32 BodyIndex, float DeltaTime)
+{
+	USimplePhysicsRigidBodyComponent* RigidBody = Bodies.Components[BodyIndex];
+	float RemainingTime = DeltaTime;
+	int32 Iterations = 0;
+	FHitResult Hit(1.f);
+	
+	// Copy, the result is only used for the first move. Bodies woken this step have no result
+	const FSimplePhysicsIntegrationResult Integration = StageOutput.IntegrationResults.IsValidIndex(BodyIndex) ? StageOutput.IntegrationResults[BodyIndex] : FSimplePhysicsIntegrationResult();
+
+	while (RemainingTime >= MIN_TICK_TIME && (Iterations < MaxSimulationIterations) && RigidBody->UpdatedComponent && RigidBody->IsActive())
+	{
+		Iterations++;
+		++Stats.NumIterations;
+
+		// Smaller ticks where all bodies move together are done by StepSimulation() when substepping is enabled
+		const float TimeTick = RemainingTime;
+		RemainingTime -= TimeTick;
+
+		// Initial move state
+		Hit.Time = 1.f;
+		const FVector OldVelocity = Bodies.Velocities[BodyIndex];
+		const FVector OldAngularVelocity = Bodies.AngularVelocities[BodyIndex];
+
+		// Collision response before the move invalidates the integrated movement
+		const bool bUseIntegration = (Iterations == 1) && Integration.IsValidFor(OldVelocity, OldAngularVelocity);
+
+		// Move with the velocity before the contact up to the time of impact, then with the velocity after the contact
+		const float ContactTime = (Iterations == 1 && !bUseIntegration && ContactTimes.IsValidIndex(BodyIndex)) ? ContactTimes[BodyIndex] : 1.f;
+		const float IntegrationTime = TimeTick * (1.f - ContactTime);
+
+		FVector MoveDelta = Integration.MoveDelta;
+		if (ContactTime < 1.f)
+		{
+			MoveDelta = Bodies.ComputeMoveDelta(BodyIndex, Integration.StartVelocity, TimeTick * ContactTime) + Bodies.ComputeMoveDelta(BodyIndex, OldVelocity, IntegrationTime);
+		}
+		else if (!bUseIntegration)
+		{
+			MoveDelta = Bodies.ComputeMoveDelta(BodyIndex, OldVelocity, TimeTick);
+		}
+
+		// Resting against the same surface as last step, so slide along it instead of bouncing off it again
+		FVector RestingNormal;
+		const bool bResting = (Iterations == 1) && bWarmStartContacts && FindRestingContact(BodyIndex, MoveDelta, TimeTick, RestingNormal);
+		if (bResting)
+		{
+			++Stats.NumRestingMoves;
+			MoveDelta -= FVector::DotProduct(MoveDelta, RestingNormal) * RestingNormal;
+		}
+
+		// Handle Rotation here
+
+		// Only sweep up to the first static collider, static colliders are never hit by the sweep
+		FHitResult StaticHit;
+		const bool bStaticHit = FindStaticHit(BodyIndex, MoveDelta, StaticHit);
+
+		// Nothing but the static colliders can be in the way of the free flight move, so the engine sweep is not needed
+		const bool bSkipSweep = bUseIntegration && CanTeleportBody(BodyIndex, MoveDelta);
+
+		// Nothing is in the way at all. The transform is written with all other teleported bodies
+		if (bSkipSweep && !bStaticHit)
+		{
+			++Stats.NumTeleports;
+			Bodies.Positions[BodyIndex] += MoveDelta;
+			Bodies.ApplyIntegrationResult(BodyIndex, Integration);
+			TeleportedBodies.Add(BodyIndex);
+
+			if (bResting)
+			{
+				ApplyRestingContact(BodyIndex, RestingNormal);
+			}
+
+			return;
+		}
+
+		if (bSkipSweep)
+		{
+			// Move up to the static collider without a scene query, the following bounce is handled as usual
+			++Stats.NumTeleports;
+			RigidBody->MoveUpdatedComponent(MoveDelta * StaticHit.Time, RigidBody->UpdatedComponent->GetComponentQuat(), false);
+			Hit = StaticHit;
+		}
+		else
+		{
+			RigidBody->SafeMoveUpdatedComponent(bStaticHit ? MoveDelta * StaticHit.Time : MoveDelta, RigidBody->UpdatedComponent->GetComponentRotation(), true, Hit);
+
+			if (bStaticHit)
+			{
+				if (Hit.bBlockingHit)
+				{
+					// Something else was hit first, make the hit time relative to the full move
+					Hit.Time *= StaticHit.Time;
+				}
+				else
+				{
+					Hit = StaticHit;
+				}
+			}
+		}
+
+		// If we hit a trigger that destroyed us, abort.
+		if (!Bodies.IsValidIndex(BodyIndex) || !IsValid(RigidBody->UpdatedComponent) || !IsValid(RigidBody->UpdatedComponent->GetOwner()))
+		{
+			++Stats.NumAborts;
+			return;
+		}
+
+		Bodies.Positions[BodyIndex] = RigidBody->UpdatedComponent->GetComponentLocation();
+
+		if (!Hit.bBlockingHit)
+		{
+			if (bUseIntegration)
+			{
+				Bodies.ApplyIntegrationResult(BodyIndex, Integration);
+			}
+			else
+			{
+				Bodies.UpdateMovementVelocity(BodyIndex, OldVelocity, OldAngularVelocity, (ContactTime < 1.f) ? IntegrationTime : TimeTick);
+			}
+
+			if (bResting)
+			{
+				ApplyRestingContact(BodyIndex, RestingNormal);
+			}
+		}
+		else
+		{
+			// TODO: Update with new function SetMovementVelocityFromHit()
+			if (Hit.Time > UE_KINDA_SMALL_NUMBER)
+			{
+				Bodies.UpdateMovementVelocity(BodyIndex, OldVelocity, OldAngularVelocity, TimeTick * Hit.Time);
+			}
+
+			float SubTickTimeRemaining = TimeTick * (1.f - Hit.Time);
+
+			if (ShouldAbort(BodyIndex, Hit))
+			{
+				++Stats.NumAborts;
+
+				// Pushed out at the end of the step, so the body does not abort again every step
+				if (Hit.bStartPenetrating && bDepenetrateStuckBodies && Bodies.IsValidIndex(BodyIndex))
+				{
+					StuckBodies.Add(Bodies.GetHandle(BodyIndex), RigidBody->GetPenetrationAdjustment(Hit));
+				}
+
+				break;
+			}
+
+			const int32 OtherHitBodyIndex = GetOtherHitBodyIndex(Hit);
+			if (OtherHitBodyIndex != INDEX_NONE)
+			{
+				HandleRigidBodyCollision(BodyIndex, OtherHitBodyIndex, Hit);
+			}
+			else
+			{
+				const FVector ImpactVelocity = Bodies.Velocities[BodyIndex];
+				HandleImpact(BodyIndex, Hit, TimeTick, MoveDelta);
+
+				if (bWarmStartContacts)
+				{
+					UpdateRestingContact(BodyIndex, Hit, ImpactVelocity);
+				}
+			}
+
+			// Bounce events are only sent after all bodies moved, so collision logic can not remove the body here
+
+			// Add Handle Deflection similar the projectile movement here if needed
+
+			if (IsBelowSimulationVelocity(BodyIndex))
+			{
+				PutToSleep(BodyIndex);
+				break;
+			}
+
+			if (bKeepLastHitResults)
+			{
+				LastHitResults.Add(Bodies.GetHandle(BodyIndex), Hit);
+			}
+
+			Bodies.SetVelocity(BodyIndex, Bodies.Velocities[BodyIndex]);
+
+
+			if (SubTickTimeRemaining >= MIN_TICK_TIME)
+			{
+				RemainingTime += SubTickTimeRemaining;
+			}
+		}
+	}
+}
+
+
+bool USimplePhysicsSolver::FindRestingContact(int32 BodyIndex, const FVector& MoveDelta, float DeltaTime, FVector& OutNormal)
+{
+	const FSimplePhysicsBodyHandle Handle = Bodies.GetHandle(BodyIndex);
+	const FSimplePhysicsRestingContact* Contact = RestingContacts.Find(Handle);
+	if (!Contact)
+	{
+		return false;
+	}
+
+	// The surface has to be hit by a sweep again every few steps, so contacts with moved or removed geometry do not last
+	if (StepCount - Contact->ConfirmedStep > RestingContactLifetimeSteps || (Contact->bHasObject && !Contact->Object.IsValid()))
+	{
+		RestingContacts.Remove(Handle);
+		return false;
+	}
+
+	// Bodies leaving the surface or hitting it hard move and bounce as usual
+	const float ApproachSpeed = -FVector::DotProduct(MoveDelta, Contact->Normal) / FMath::Max(DeltaTime, MIN_TICK_TIME);
+	if (ApproachSpeed <= 0.f || ApproachSpeed > RestingContactSpeed)
+	{
+		return false;
+	}
+
+	OutNormal = Contact->Normal;
+	return true;
+}
+
+
+void USimplePhysicsSolver::ApplyRestingContact(int32 BodyIndex, const FVector& Normal)
 {
-	return RigidBody && IsValid(RigidBody->UpdatedComponent) &&
-		   !RigidBody->ShouldSkipUpdate(DeltaTime) &&
-		   !RigidBody->UpdatedComponent->IsSimulatingPhysics();
-}
+	FVector Velocity = Bodies.Velocities[BodyIndex];
+	const float NormalSpeed = FVector::DotProduct(Velocity, Normal);
+	if (NormalSpeed < 0.f)
+	{
+		Velocity -= NormalSpeed * Normal;
 
+		// Friction takes away at most Friction times the velocity the surface took away
+		const float FrictionSpeed = FMath::Min(-NormalSpeed * Bodies.Params[BodyIndex].Friction, static_cast<float>(Velocity.Size()));
+		Velocity -= Velocity.GetSafeNormal() * FrictionSpeed;
+	}
 
-void USimplePhysicsSolver::ApplyRigidBodyMovement(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody, float DeltaTime)
-{
-	float RemainingTime = DeltaTime;
-	//int32 NumImpacts = 0;
-	int32 NumBounces = 0;
-	int32 LoopCount = 0;
-	int32 Iterations = 0;
-	FHitResult Hit(1.f);
-	
+	Bodies.SetVelocity(BodyIndex, Velocity);
+
+	if (IsBelowSimulationVelocity(BodyIndex))
+	{
+		PutToSleep(BodyIndex);
+	}
+}
 
-	const FVector AngularVelocityDelta = RigidBody->ComputeAngularVelocityDelta(RigidBody->AngularVelocity, DeltaTime);
-	//UE_LOG(LogTemp, Warning, TEXT("AngularVelocityDelta: %s"), *AngularVelocityDelta.ToString());
-	//RigidBody->ApplyRotationDelta(FRotator(AngularVelocityDelta.Y, AngularVelocityDelta.Z, AngularVelocityDelta.X));
-	//RigidBody->AddAngularVelocity(AngularVelocityDelta);
 
-	//FVector DeltaRotation = (RigidBody->AngularVelocity * DeltaTime);
-	//if (AActor* Owner = RigidBody->GetOwner())
-	//{
-	//	//FQuat CurrentRotation = Owner->GetActorQuat();
-	//	//FQuat DeltaQuat = FQuat(DeltaRotation.GetSafeNormal(), DeltaRotation.Length());
-	//	//Owner->SetActorRotation(CurrentRotation * DeltaQuat);
+void USimplePhysicsSolver::UpdateRestingContact(int32 BodyIndex, const FHitResult& Hit, const FVector& ImpactVelocity)
+{
+	const FSimplePhysicsBodyHandle Handle = Bodies.GetHandle(BodyIndex);
+	if (-FVector::DotProduct(ImpactVelocity, Hit.Normal) > RestingContactSpeed)
+	{
+		RestingContacts.Remove(Handle);
+		return;
+	}
 
+	const UObject* Object = Hit.GetComponent() ? static_cast<const UObject*>(Hit.GetComponent()) : Hit.GetActor();
 
-	//	FRotator NewAngularVelocity;
-	//	NewAngularVelocity.Roll = DeltaRotation.X;
-	//	NewAngularVelocity.Pitch = DeltaRotation.Y;
-	//	NewAngularVelocity.Yaw = DeltaRotation.Z;
-	//	Owner->AddActorWorldRotation(NewAngularVelocity);
-	//	//FRotator DT = FRotator(RigidBody->AngularVelocity * DeltaTime);
+	FSimplePhysicsRestingContact& Contact = RestingContacts.FindOrAdd(Handle);
+	Contact.Object = Object;
+	Contact.bHasObject = (Object != nullptr);
+	Contact.Normal = Hit.Normal;
+	Contact.ConfirmedStep = StepCount;
+}
 
-	//	//FRotator CurrentRotation = Owner->GetActorRotation();
-	//	//FRotator DeltaRotation = FRotator(RigidBody->AngularVelocity.X * DeltaTime,
-	//	//								  RigidBody->AngularVelocity.Z * DeltaTime,
-	//	//								  RigidBody->AngularVelocity.Y * DeltaTime
-	//	//								  
-	//	//									);
 
-	//	//Owner->SetActorRelativeRotation(CurrentRotation + DeltaRotation);
-	//}
+void USimplePhysicsSolver::HandleImpact(int32 BodyIndex, const FHitResult& Hit, float TimeSlice, const FVector& MoveDelta)
+{
+	const FVector OldVelocity = Bodies.Velocities[BodyIndex];
+	//FVector NewVelocity = ComputeBounceResult(RigidBody, Hit, TimeSlice, MoveDelta);
 
-	////if (auto Sphere = Cast<USphereComponent>(RigidBody->UpdatedComponent))
-	////{
-	////	UE_LOG(LogTemp, Warning, TEXT("I have a sphere"));
-	////}
+	FMovementData BounceResultMovementData;
+	if (ComputeBounceResult(BodyIndex, Hit, TimeSlice, MoveDelta, BounceResultMovementData))
+	{
+		SetBodyMovementData(BodyIndex, BounceResultMovementData);
+		QueueBounceEvent(BodyIndex, Hit, OldVelocity, Bodies.Velocities[BodyIndex]);
+	}
+}
 
 
-	while (RemainingTime >= MIN_TICK_TIME && (Iterations < MaxSimulationIterations) && RigidBody->UpdatedComponent && RigidBody->IsActive())
+void USimplePhysicsSolver::QueueBounceEvent(int32 BodyIndex, const FHitResult& Hit, const FVector& ImpactVelocity, const FVector& ResultVelocity)
+{
+	const int32 EventIndex = Bodies.BounceEventIndices[BodyIndex];
+	if (BounceEvents.IsValidIndex(EventIndex))
 	{
-		LoopCount++;
-		Iterations++;
+		// Keep the first hit of the frame and report where the body ended up
+		BounceEvents[EventIndex].ResultVelocity = ResultVelocity;
+		return;
+	}
 
-		// subdivide long ticks to more closely follow parabolic trajectory
-		const float InitialTimeRemaining = RemainingTime;
+	Bodies.BounceEventIndices[BodyIndex] = BounceEvents.Num();
 
-		// TODO: Restructure allow for smaller ticks (simulate small movement for each object, then simulate again
-		//const float TimeTick = ShouldUseSubStepping() ? GetSimulationTimeStep(RemainingTime, Iterations) : RemainingTime;
-		const float TimeTick = RemainingTime;
-		RemainingTime -= TimeTick;
+	FSimplePhysicsBounceEvent& Event = BounceEvents.AddDefaulted_GetRef();
+	Event.Body = Bodies.GetHandle(BodyIndex);
+	Event.Hit = Hit;
+	Event.ImpactVelocity = ImpactVelocity;
+	Event.ResultVelocity = ResultVelocity;
+}
 
-		// Initial move state
-		Hit.Time = 1.f;
-		const FVector OldVelocity = RigidBody->Velocity;
-		const FVector OldAngularVelocity = RigidBody->AngularVelocity;
-		const FVector MoveDelta = RigidBody->ComputeMoveDelta(OldVelocity, TimeTick);
 
-		// Handle Rotation here
+void USimplePhysicsSolver::DispatchBounceEvents()
+{
+	// Listeners can add, remove or bounce bodies. Events they cause are sent next frame
+	TArray<FSimplePhysicsBounceEvent> Events = MoveTemp(BounceEvents);
+	BounceEvents.Reset();
 
-		RigidBody->SafeMoveUpdatedComponent(MoveDelta, RigidBody->UpdatedComponent->GetComponentRotation(), true, Hit);
+	// Resolve every receiver first, so all bodies see the state of this frame. Only bodies that bounced are visited
+	TArray<TObjectPtr<USimplePhysicsRigidBodyComponent>, TInlineAllocator<16>> Receivers;
+	Receivers.SetNumZeroed(Events.Num());
 
-		// If we hit a trigger that destroyed us, abort.
-		if (!IsValid(RigidBody) || !IsValid(RigidBody->UpdatedComponent) || !IsValid(RigidBody->UpdatedComponent->GetOwner()))
+	for (int32 EventIndex = 0; EventIndex < Events.Num(); ++EventIndex)
+	{
+		// Removed bodies no longer resolve, their events are dropped
+		const int32 BodyIndex = Bodies.FindIndex(Events[EventIndex].Body);
+		if (Bodies.IsValidIndex(BodyIndex))
 		{
-			return;
+			Bodies.BounceEventIndices[BodyIndex] = INDEX_NONE;
+			Receivers[EventIndex] = Bodies.Components[BodyIndex];
 		}
+	}
 
-		if (!Hit.bBlockingHit)
-		{
-			RigidBody->UpdateMovementVelocity(OldVelocity, TimeTick);
-			RigidBody->UpdateMovementAngularVelocity(OldAngularVelocity, TimeTick);
-		}
-		else
+	for (int32 EventIndex = 0; EventIndex < Events.Num(); ++EventIndex)
+	{
+		USimplePhysicsRigidBodyComponent* RigidBody = Receivers[EventIndex];
+		if (!IsValid(RigidBody))
 		{
-			// TODO: Update with new function SetMovementVelocityFromHit()
-			RigidBody->UpdateMovementVelocity(OldVelocity, Hit, TimeTick);
-			RigidBody->UpdateMovementAngularVelocity(OldAngularVelocity, Hit, TimeTick);
-			//if (RigidBody->Velocity == OldVelocity)
-			//{
-			//	const FVector NewVelocity = RigidBody->ComputeVelocity(OldVelocity, TimeTick * Hit.Time);
-			//	RigidBody->Velocity = (Hit.Time > UE_KINDA_SMALL_NUMBER) ? NewVelocity : OldVelocity;
-			//}
-
-			//NumImpacts++;
-			float SubTickTimeRemaining = TimeTick * (1.f - Hit.Time);
-
-			if (ShouldAbort(RigidBody, Hit))
-			{
-				break;
-			}
-
-			if (USimplePhysicsRigidBodyComponent* OtherHitRigidBody = GetOtherHitRigidBody(Hit))
-			{
-				HandleRigidBodyCollision(RigidBody, OtherHitRigidBody, Hit);
-			}
-			else
-			{
-				HandleImpact(RigidBody, Hit, TimeTick, MoveDelta);
-			}
-
-			if (ShouldAbort(RigidBody, Hit))
-			{
-				break;
-			}
-
-			// Add Handle Deflection similar the projectile movement here if needed
-
-			if (IsBelowSimulationVelocity(RigidBody))
-			{
-				UE_LOG(LogTemp, Warning, TEXT("IsBelowSimulationVelocity"));
-				StopSimulating(RigidBody);
-				break;
-			}
-
-			RigidBody->SetLastBlockingHitResult(Hit);
-			RigidBody->LimitVelocityFromCurrent();
-
-
-			if (SubTickTimeRemaining >= MIN_TICK_TIME)
-			{
-				RemainingTime += SubTickTimeRemaining;
-			}
+			continue;
 		}
 
-		RigidBody->UpdateComponentVelocity();
+		const FSimplePhysicsBounceEvent& Event = Events[EventIndex];
+		RigidBody->OnRigidBodyBounceNativeDelegate.Broadcast(Event.Hit, Event.ImpactVelocity, Event.ResultVelocity);
+		RigidBody->OnRigidBodyBounceDelegate.Broadcast(Event.Hit, Event.ImpactVelocity, Event.ResultVelocity);
 	}
 }
 
 
-void USimplePhysicsSolver::HandleImpact(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody, const FHitResult& Hit, float TimeSlice, const FVector& MoveDelta)
+void USimplePhysicsSolver::DispatchEscapeEvents()
 {
-	const FVector OldVelocity = RigidBody->Velocity;
-	//FVector NewVelocity = ComputeBounceResult(RigidBody, Hit, TimeSlice, MoveDelta);
+	// Listeners usually return the body to a pool, which can add or remove bodies
+	TArray<FSimplePhysicsBodyHandle> Escaped = MoveTemp(EscapedBodies);
+	EscapedBodies.Reset();
 
-	FMovementData BounceResultMovementData;
-	if (ComputeBounceResult(RigidBody, Hit, TimeSlice, MoveDelta, BounceResultMovementData))
+	for (const FSimplePhysicsBodyHandle& Handle : Escaped)
 	{
-		RigidBody->OnRigidBodyBounceDelegate.Broadcast(Hit, OldVelocity, BounceResultMovementData.LinearVelocity);
+		const int32 BodyIndex = Bodies.FindIndex(Handle);
+		if (!Bodies.IsValidIndex(BodyIndex))
+		{
+			continue;
+		}
 
-		//RigidBody->SetVelocity(BounceResultMovementData.LinearVelocity);
-		RigidBody->SetMovementData(BounceResultMovementData);
+		USimplePhysicsRigidBodyComponent* RigidBody = Bodies.Components[BodyIndex];
+		RigidBody->OnEscapedDelegate.Broadcast();
 	}
 }
 
 
-bool USimplePhysicsSolver::ComputeBounceResult(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody, const FHitResult& Hit, float TimeSlice, const FVector& MoveDelta, FMovementData& ResultMovementData)
+bool USimplePhysicsSolver::ComputeBounceResult(int32 BodyIndex, const FHitResult& Hit, float TimeSlice, const FVector& MoveDelta, FMovementData& ResultMovementData)
 {
-	FVector TempVelocity = RigidBody->Velocity;
-	FVector TempAngularVelocity = RigidBody->AngularVelocity;
+	const FSimplePhysicsBodyParams& BodyParams = Bodies.Params[BodyIndex];
+
+	FVector TempVelocity = Bodies.Velocities[BodyIndex];
+	FVector TempAngularVelocity = Bodies.AngularVelocities[BodyIndex];
 	FVector VelocityNormal = TempVelocity.GetSafeNormal();
-	const FVector Normal = RigidBody->ConstrainNormalToPlane(Hit.Normal);
+	const FVector Normal = BodyParams.ConstrainNormalToPlane(Hit.Normal);
 	const float VelocityDotNormal = FVector::DotProduct(TempVelocity, Normal);
 
 	// Calculate how parrel the impact velocity is to the surface
@@ -309,36 +2796,36 @@ bool USimplePhysicsSolver::ComputeBounceResult(TObjectPtr<USimplePhysicsRigidBod
 		// Point velocity in direction parallel to surface
 		TempVelocity += ProjectedNormal;
 
-		const bool SouldScaleFriction = /* RigidBody->bIsSliding || */ RigidBody->bBounceAngleAffectsFriction;
+		const bool SouldScaleFriction = /* RigidBody->bIsSliding || */ BodyParams.bBounceAngleAffectsFriction;
 		if (SouldScaleFriction)
 		{
 			// Get how much parrel the bounce angle is to the surface. The closer to parrel the more friction to apply
-			const float Friction = FMath::Clamp(FMath::Abs(VelocityDotNormal / TempVelocity.Size()), RigidBody->MinFrictionFraction, 1.f) * RigidBody->Friction;
+			const float Friction = FMath::Clamp(FMath::Abs(VelocityDotNormal / TempVelocity.Size()), BodyParams.MinFrictionFraction, 1.f) * BodyParams.Friction;
 
 			// Only tangential velocity should be affected by friction.
 			TempVelocity *= FMath::Clamp(1.f - Friction, 0.f, 1.f);
 		}
 		else
 		{
-			TempVelocity *= FMath::Clamp(1.f - RigidBody->Friction, 0.f, 1.f);
+			TempVelocity *= FMath::Clamp(1.f - BodyParams.Friction, 0.f, 1.f);
 		}
 
 		// Coefficient of restitution only applies perpendicular to impact.
-		TempVelocity += (ProjectedNormal * FMath::Max(RigidBody->Bounciness, 0.f));
+		TempVelocity += (ProjectedNormal * FMath::Max(BodyParams.Bounciness, 0.f));
 
 		// Bounciness could cause us to exceed max speed.
 		//TempVelocity = RigidBody->LimitVelocity(TempVelocity);
 
-		FVector RelativeVelocity = RigidBody->Velocity;
+		FVector RelativeVelocity = Bodies.Velocities[BodyIndex];
 
 		const float RelativeSpeedAlongNormal = VelocityDotNormal; //FVector::DotProduct(RelativeVelocity, Hit.Normal);
 		float ImpulseMagnitude = -(1.0f) * RelativeSpeedAlongNormal;
 
 
-		float DeltaAngularVelocityMagnitude = ImpulseMagnitude / RigidBody->GetMomentOfInertia();
+		float DeltaAngularVelocityMagnitude = ImpulseMagnitude * Bodies.InverseMomentsOfInertia[BodyIndex];
 
 
-		const FVector CollisionPointRelativeToCenter = Hit.ImpactPoint - RigidBody->UpdatedComponent->GetComponentLocation();
+		const FVector CollisionPointRelativeToCenter = Hit.ImpactPoint - Bodies.Positions[BodyIndex];
 		FVector AxisOfRotation = FVector::CrossProduct(CollisionPointRelativeToCenter, Hit.Normal).GetSafeNormal();
 		//UE_LOG(LogTemp, Warning, TEXT("Surface Normal: %s"), *Hit.Normal.ToString());
 		if (FMath::Abs(Hit.Normal.Z) < 0.9f)
@@ -348,7 +2835,7 @@ bool USimplePhysicsSolver::ComputeBounceResult(TObjectPtr<USimplePhysicsRigidBod
 
 		//UE_LOG(LogTemp, Warning, TEXT("AxisOfRotation: %s"), *AxisOfRotation.ToString());
 
-		const FVector DeltaAngularVelocity = AxisOfRotation * DeltaAngularVelocityMagnitude * RigidBody->TempScale;
+		const FVector DeltaAngularVelocity = AxisOfRotation * DeltaAngularVelocityMagnitude * BodyParams.TempScale;
 
 
 
@@ -385,37 +2872,323 @@ bool USimplePhysicsSolver::ComputeBounceResult(TObjectPtr<USimplePhysicsRigidBod
 
 	
 
-		ResultMovementData.Set(TempVelocity, DeltaAngularVelocity + RigidBody->AngularVelocity);
+		ResultMovementData.Set(TempVelocity, DeltaAngularVelocity + TempAngularVelocity);
 	}
 
 	return true;
 }
 
 
-bool USimplePhysicsSolver::IsBelowSimulationVelocity(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody) const
+bool USimplePhysicsSolver::IsBelowSimulationVelocity(int32 BodyIndex) const
 {
-	return RigidBody->Velocity.SizeSquared() < FMath::Square(MinimumSimulationVelocity);
+	return Bodies.Velocities[BodyIndex].SizeSquared() < FMath::Square(MinimumSimulationVelocity);
 }
 
 
-void USimplePhysicsSolver::StopSimulating(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody)
+void USimplePhysicsSolver::PutToSleep(int32 BodyIndex)
 {
-	if (!RigidBody->HasPendingForce())
+	if (!Bodies.HasPendingForce(BodyIndex))
 	{
-		InvalidRigidBodies.Add(RigidBody);
-		RigidBody->SetVelocity(FVector::ZeroVector);
-		RigidBody->OnSimulationStopDelegate.Broadcast();
+		// Stop now so following substeps do not move the body
+		Bodies.SetSimulating(BodyIndex, false);
+		Bodies.SetVelocity(BodyIndex, FVector::ZeroVector);
+		Bodies.SetAngularVelocity(BodyIndex, FVector::ZeroVector);
+		Bodies.WriteComponentState(BodyIndex);
+		SetBodySleeping(BodyIndex, true);
+
+		Bodies.Components[BodyIndex]->OnSimulationStopDelegate.Broadcast();
 	}
 }
 
 
-bool USimplePhysicsSolver::ShouldAbort(USimplePhysicsRigidBodyComponent* RigidBody, const FHitResult& Hit) const
+void USimplePhysicsSolver::SetBodySleeping(int32 BodyIndex, bool bSleeping)
 {
-	if (!IsValid(RigidBody))
+	if (Bodies.Sleeping[BodyIndex] == bSleeping)
+	{
+		return;
+	}
+
+	Bodies.SetSleeping(BodyIndex, bSleeping);
+	bSleepingBroadphaseDirty = true;
+	++BodyStateGeneration;
+
+	USimplePhysicsRigidBodyComponent* RigidBody = Bodies.Components[BodyIndex];
+	USceneComponent* UpdatedComponent = RigidBody->UpdatedComponent;
+	FDelegateHandle& MoveHandle = Bodies.SleepMoveHandles[BodyIndex];
+
+	if (bSleeping && IsValid(UpdatedComponent))
+	{
+		MoveHandle = UpdatedComponent->TransformUpdated.AddUObject(this, &USimplePhysicsSolver::OnSleepingBodyMoved, RigidBody);
+	}
+	else if (MoveHandle.IsValid())
+	{
+		if (IsValid(UpdatedComponent))
+		{
+			UpdatedComponent->TransformUpdated.Remove(MoveHandle);
+		}
+
+		MoveHandle.Reset();
+	}
+}
+
+
+void USimplePhysicsSolver::WakeBody(int32 BodyIndex)
+{
+	SetBodySleeping(BodyIndex, false);
+
+	if (!Bodies.Simulating[BodyIndex])
+	{
+		Bodies.RefreshParams(BodyIndex);
+		Bodies.ReadComponentState(BodyIndex);
+		Bodies.SetSimulating(BodyIndex, true);
+		++BodyStateGeneration;
+
+		// Woken bodies have not waited for any steps
+		Bodies.LastUpdateSteps[BodyIndex] = StepCount - 1;
+	}
+}
+
+
+void USimplePhysicsSolver::WakeIsland(int32 BodyIndex)
+{
+	UpdateSleepingBroadphase();
+
+	// Bodies are woken as they are queued, so a body that is no longer sleeping is never queued twice
+	WakeQueue.Reset();
+	WakeQueue.Add(BodyIndex);
+	WakeBody(BodyIndex);
+
+	// Breadth first, WakeQueue grows while iterating
+	for (int32 QueueIndex = 0; QueueIndex < WakeQueue.Num(); ++QueueIndex)
+	{
+		const int32 WokenBodyIndex = WakeQueue[QueueIndex];
+
+		if (SleepingBroadphase.IsEmpty() || !Bodies.CollisionEnabled[WokenBodyIndex])
+		{
+			continue;
+		}
+
+		// SleepingBroadphase is not rebuilt while waking, so skip bodies already woken
+		const FVector& Location = Bodies.Positions[WokenBodyIndex];
+		const float Reach = Bodies.Radii[WokenBodyIndex] + WakeContactTolerance;
+
+		SleepingQueryResults.Reset();
+		SleepingBroadphase.Query(FBox(Location - FVector(Reach), Location + FVector(Reach)), SleepingQueryResults);
+
+		for (const int32 SleepingBodyIndex : SleepingQueryResults)
+		{
+			if (!Bodies.Sleeping[SleepingBodyIndex])
+			{
+				continue;
+			}
+
+			if (!Bodies.ShouldCollide(WokenBodyIndex, SleepingBodyIndex, SimulationTime))
+			{
+				continue;
+			}
+
+			const float TouchDistance = Reach + Bodies.Radii[SleepingBodyIndex];
+			if (FVector::DistSquared(Location, Bodies.Positions[SleepingBodyIndex]) <= FMath::Square(TouchDistance))
+			{
+				WakeQueue.Add(SleepingBodyIndex);
+				WakeBody(SleepingBodyIndex);
+			}
+		}
+	}
+}
+
+
+void USimplePhysicsSolver::OnSleepingBodyMoved(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport, USimplePhysicsRigidBodyComponent* RigidBody)
+{
+	const int32 BodyIndex = Bodies.FindIndex(RigidBody);
+	if (Bodies.IsValidIndex(BodyIndex) && Bodies.Sleeping[BodyIndex])
+	{
+		if (ShouldDeferInput())
+		{
+			// Queued like other inputs. Pending simulation changes are not read by the async stage, and drop the step it prepared
+			RequestSimulationChange(BodyIndex, ESimplePhysicsPendingSimulation::Enable);
+		}
+		else
+		{
+			WakeBody(BodyIndex);
+		}
+	}
+}
+
+
+void USimplePhysicsSolver::FindOverlappingBodies()
+{
+	if (!bDepenetrateStuckBodies)
+	{
+		return;
+	}
+
+	// Sleeping bodies do not move, so they only overlap something that moved into them
+	auto CanDepenetrate = [this](int32 BodyIndex)
+	{
+		return Bodies.Simulating[BodyIndex] && !Bodies.Sleeping[BodyIndex] && Bodies.CollisionEnabled[BodyIndex] &&
+			Bodies.PendingSimulation[BodyIndex] != ESimplePhysicsPendingSimulation::Disable;
+	};
+
+	if (!StaticColliders.IsEmpty())
+	{
+		for (int32 BodyIndex = 0; BodyIndex < Bodies.Num(); ++BodyIndex)
+		{
+			FVector StaticAdjustment;
+			if (CanDepenetrate(BodyIndex) && StaticColliders.ComputePenetration(Bodies.Positions[BodyIndex], Bodies.Radii[BodyIndex], StaticAdjustment))
+			{
+				StuckBodies.FindOrAdd(Bodies.GetHandle(BodyIndex), FVector::ZeroVector);
+			}
+		}
+	}
+
+	// Pairs of the last substep were gathered over the whole move, so they contain every pair that can overlap now
+	for (const FSimplePhysicsCandidatePair& Pair : StageOutput.CandidatePairs)
+	{
+		if (!Bodies.IsValidIndex(Pair.First) || !Bodies.IsValidIndex(Pair.Second))
+		{
+			continue;
+		}
+
+		const float TouchDistance = Bodies.Radii[Pair.First] + Bodies.Radii[Pair.Second];
+		if (FVector::DistSquared(Bodies.Positions[Pair.First], Bodies.Positions[Pair.Second]) >= FMath::Square(TouchDistance))
+		{
+			continue;
+		}
+
+		if (CanDepenetrate(Pair.First))
+		{
+			StuckBodies.FindOrAdd(Bodies.GetHandle(Pair.First), FVector::ZeroVector);
+		}
+
+		if (CanDepenetrate(Pair.Second))
+		{
+			StuckBodies.FindOrAdd(Bodies.GetHandle(Pair.Second), FVector::ZeroVector);
+		}
+	}
+}
+
+
+void USimplePhysicsSolver::DepenetrateStuckBodies()
+{
+	if (StuckBodies.Num() == 0)
+	{
+		return;
+	}
+
+	// Bodies are found at their locations after all moves of the step
+	UpdateQueryIndex();
+
+	for (const TPair<FSimplePhysicsBodyHandle, FVector>& StuckBody : StuckBodies)
+	{
+		const int32 BodyIndex = Bodies.FindIndex(StuckBody.Key);
+		if (!Bodies.IsValidIndex(BodyIndex) || !Bodies.Simulating[BodyIndex])
+		{
+			continue;
+		}
+
+		USimplePhysicsRigidBodyComponent* RigidBody = Bodies.Components[BodyIndex];
+		if (!IsValid(RigidBody->UpdatedComponent))
+		{
+			continue;
+		}
+
+		const FVector Location = Bodies.Positions[BodyIndex];
+		const float Radius = Bodies.Radii[BodyIndex];
+
+		// Out of the engine geometry the sweep started inside, then out of the static colliders and other bodies
+		FVector Adjustment = StuckBody.Value;
+
+		FVector StaticAdjustment;
+		if (StaticColliders.ComputePenetration(Location, Radius, StaticAdjustment))
+		{
+			Adjustment += StaticAdjustment;
+		}
+
+		QueryResults.Reset();
+		QueryIndex.Query(FBox(Location - FVector(Radius), Location + FVector(Radius)), QueryResults);
+
+		for (const int32 OtherBodyIndex : QueryResults)
+		{
+			if (OtherBodyIndex == BodyIndex || !Bodies.IsValidIndex(OtherBodyIndex) || !Bodies.ShouldCollide(BodyIndex, OtherBodyIndex, SimulationTime))
+			{
+				continue;
+			}
+
+			const FVector Offset = Location - Bodies.Positions[OtherBodyIndex];
+			const float Distance = Offset.Size();
+			const float Overlap = Radius + Bodies.Radii[OtherBodyIndex] - Distance;
+			if (Overlap > 0.f && Distance > UE_KINDA_SMALL_NUMBER)
+			{
+				// Both bodies of a pair are pushed out, each by half the overlap
+				const float Share = StuckBodies.Contains(Bodies.GetHandle(OtherBodyIndex)) ? 0.5f : 1.f;
+				Adjustment += Offset * (Share * Overlap / Distance);
+			}
+		}
+
+		if (Adjustment.IsNearlyZero())
+		{
+			UE_LOG(LogTemp, Verbose, TEXT("Asteroid %s is stuck and could not be pushed out"), *GetNameSafe(RigidBody->UpdatedComponent->GetOwner()));
+			continue;
+		}
+
+		Adjustment = Adjustment.GetClampedToMaxSize(MaxDepenetrationDistance);
+		RigidBody->UpdatedComponent->SetWorldLocation(Location + Adjustment, false, nullptr, ETeleportType::TeleportPhysics);
+		Bodies.Positions[BodyIndex] = RigidBody->UpdatedComponent->GetComponentLocation();
+
+		// Stop moving back into what the body was pushed out of
+		const FVector Normal = Adjustment.GetUnsafeNormal();
+		const float NormalVelocity = FVector::DotProduct(Bodies.Velocities[BodyIndex], Normal);
+		if (NormalVelocity < 0.f)
+		{
+			Bodies.SetVelocity(BodyIndex, Bodies.Velocities[BodyIndex] - Normal * NormalVelocity);
+			Bodies.WriteComponentState(BodyIndex);
+		}
+
+		++Stats.NumDepenetrations;
+	}
+
+	StuckBodies.Reset();
+	bQueryIndexDirty = true;
+}
+
+
+void USimplePhysicsSolver::FindEscapedBodies()
+{
+	if (!bDetectEscapedBodies || !SimulationBounds.IsValid)
+	{
+		return;
+	}
+
+	const FBox EscapeBounds = SimulationBounds.ExpandBy(EscapedBodyMargin);
+
+	for (int32 BodyIndex = 0; BodyIndex < Bodies.Num(); ++BodyIndex)
+	{
+		if (!Bodies.Simulating[BodyIndex] || Bodies.PendingSimulation[BodyIndex] == ESimplePhysicsPendingSimulation::Disable)
+		{
+			continue;
+		}
+
+		if (!EscapeBounds.IsInsideOrOn(Bodies.Positions[BodyIndex]))
+		{
+			// Escaped bodies cost nothing from the next step, even if no game code recycles them
+			RequestSimulationChange(BodyIndex, ESimplePhysicsPendingSimulation::Disable);
+			EscapedBodies.Add(Bodies.GetHandle(BodyIndex));
+			++Stats.NumEscapedBodies;
+		}
+	}
+}
+
+
+bool USimplePhysicsSolver::ShouldAbort(int32 BodyIndex, const FHitResult& Hit) const
+{
+	if (!Bodies.IsValidIndex(BodyIndex))
 	{
 		return true;
 	}
 
+	const USimplePhysicsRigidBodyComponent* RigidBody = Bodies.Components[BodyIndex];
+
 	AActor* ActorOwner = RigidBody->UpdatedComponent ? RigidBody->UpdatedComponent->GetOwner() : nullptr;
 	if (!IsValid(ActorOwner))
 	{
@@ -424,7 +3197,12 @@ bool USimplePhysicsSolver::ShouldAbort(USimplePhysicsRigidBodyComponent* RigidBo
 
 	if (Hit.bStartPenetrating)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Asteroid %s is stuck inside %s.%s with velocity %s!"), *GetNameSafe(ActorOwner), *Hit.HitObjectHandle.GetName(), *GetNameSafe(Hit.GetComponent()), *RigidBody->Velocity.ToString());
+		// Stuck bodies are reported by DepenetrateStuckBodies() when they can not be pushed out
+		if (!bDepenetrateStuckBodies)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Asteroid %s is stuck inside %s.%s with velocity %s!"), *GetNameSafe(ActorOwner), *Hit.HitObjectHandle.GetName(), *GetNameSafe(Hit.GetComponent()), *Bodies.Velocities[BodyIndex].ToString());
+		}
+
 		return true;
 	}
 
@@ -432,108 +3210,111 @@ bool USimplePhysicsSolver::ShouldAbort(USimplePhysicsRigidBodyComponent* RigidBo
 }
 
 
-TObjectPtr<USimplePhysicsRigidBodyComponent> USimplePhysicsSolver::GetOtherHitRigidBody(const FHitResult& Hit) const
+int32 USimplePhysicsSolver::GetOtherHitBodyIndex(const FHitResult& Hit) const
 {
 	if (AActor* OtherActor = Hit.GetActor())
 	{
-		return OtherActor->GetComponentByClass<USimplePhysicsRigidBodyComponent>();
+		if (const USimplePhysicsRigidBodyComponent* OtherRigidBody = OtherActor->GetComponentByClass<USimplePhysicsRigidBodyComponent>())
+		{
+			return Bodies.FindIndex(OtherRigidBody);
+		}
 	}
 
-	return nullptr;
+	return INDEX_NONE;
 }
 
 
-void USimplePhysicsSolver::HandleRigidBodyCollision(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody, TObjectPtr<USimplePhysicsRigidBodyComponent> OtherRigidBody, const FHitResult& Hit)
+void USimplePhysicsSolver::HandleRigidBodyCollision(int32 BodyIndex, int32 OtherBodyIndex, const FHitResult& Hit)
 {
-	if (RigidCollisionResultMap.Contains(RigidBody))
-	{
-		RigidBody->SetMovementData(RigidCollisionResultMap[RigidBody]);
-	}
-	else
+	// Sleeping bodies still have simulation enabled and are always woken
+	const bool OtherRigidBodySimulating = Bodies.Simulating[OtherBodyIndex];
+	if (OtherRigidBodySimulating || Bodies.Sleeping[OtherBodyIndex] || Bodies.Params[OtherBodyIndex].bEnableSimulationOnRigidBodyCollision)
 	{
-		const bool OtherRigidBodySimulating = SimulatedRigidBodies.Contains(OtherRigidBody);
-		if (OtherRigidBodySimulating || OtherRigidBody->bEnableSimulationOnRigidBodyCollision)
+		FMovementData RigidBodyMovementData, OtherRigidBodyMovementData;
+		if (ComputeRigidBodyCollision(Hit, BodyIndex, OtherBodyIndex, RigidBodyMovementData, OtherRigidBodyMovementData))
 		{
-			FMovementData RigidBodyMovementData, OtherRigidBodyMovementData;
-			if (ComputeRigidBodyCollision(Hit, RigidBody, OtherRigidBody, RigidBodyMovementData, OtherRigidBodyMovementData))
-			{
-				RigidCollisionResultMap.Emplace(RigidBody, RigidBodyMovementData);
-				RigidCollisionResultMap.Emplace(OtherRigidBody, OtherRigidBodyMovementData);
-
-				RigidBody->SetMovementData(RigidBodyMovementData);
-				OtherRigidBody->SetMovementData(OtherRigidBodyMovementData);
-
-				if (!OtherRigidBodySimulating)
-				{
-					OtherRigidBody->SetSimulationEnabled(true);
-				}
+			SetBodyMovementData(BodyIndex, RigidBodyMovementData);
+			SetBodyMovementData(OtherBodyIndex, OtherRigidBodyMovementData);
 
-				return;
+			if (!OtherRigidBodySimulating)
+			{
+				WakeIsland(OtherBodyIndex);
 			}
-		}
 
-		HandleImpact(RigidBody, Hit, 0.f, FVector());
+			return;
+		}
 	}
+
+	HandleImpact(BodyIndex, Hit, 0.f, FVector());
 }
 
 
-bool USimplePhysicsSolver::ComputeRigidBodyCollision(const FHitResult& Hit, TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody1, TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody2, FMovementData& RigidBody1MovementData, FMovementData& RigidBody2MovementData) const
+bool USimplePhysicsSolver::ComputeRigidBodyCollision(const FHitResult& Hit, int32 BodyIndex1, int32 BodyIndex2, FMovementData& RigidBody1MovementData, FMovementData& RigidBody2MovementData) const
 {
 	//DrawDebugSphere(GetWorld(), Hit.ImpactPoint, 10, 26, FColor(181, 0, 0), true, -1, 0, 2);
 
-	if (!RigidBody1 || !RigidBody2)
+	if (!Bodies.IsValidIndex(BodyIndex1) || !Bodies.IsValidIndex(BodyIndex2))
 	{
 		return false;
 	}
 
-	const float Mass1 = RigidBody1->GetMass();
-	const float Mass2 = RigidBody2->GetMass();
+	const float InverseMass1 = Bodies.InverseMasses[BodyIndex1];
+	const float InverseMass2 = Bodies.InverseMasses[BodyIndex2];
+
+	check(InverseMass1 > 0.f && InverseMass2 > 0.f);
+
+	FVector TempVelocity1 = Bodies.Velocities[BodyIndex1];
+	FVector TempVelocity2 = Bodies.Velocities[BodyIndex2];
 
-	check(Mass1 > 0.f && Mass2 > 0.f);
+	// Calculate collision normal. Use the locations at the time of impact, the start of the tick can be far from the contact for fast bodies
+	FVector CollisionNormal = -Hit.ImpactNormal;
+	FVector Location1 = Hit.Location;
+	FVector Location2 = Hit.ImpactPoint + CollisionNormal * Bodies.Radii[BodyIndex2];
 
-	FVector TempVelocity1 = RigidBody1->Velocity;
-	FVector TempVelocity2 = RigidBody2->Velocity;
+	if (CollisionNormal.IsNearlyZero())
+	{
+		Location1 = Bodies.Positions[BodyIndex1];
+		Location2 = Bodies.Positions[BodyIndex2];
+		CollisionNormal = (Location2 - Location1).GetSafeNormal();
+	}
 
 	// Calculate relative velocity
 	const FVector RelativeVelocity = TempVelocity2 - TempVelocity1;
 
-	// Calculate collision normal
-	const FVector CollisionNormal = (RigidBody2->UpdatedComponent->GetComponentLocation() - RigidBody1->UpdatedComponent->GetComponentLocation()).GetSafeNormal();
-
-	// Calculate impulse along the normal
-	float Impulse =	(2.0f * Mass1 * Mass2) / (Mass1 + Mass2) * FVector::DotProduct(RelativeVelocity, CollisionNormal);
+	// Calculate impulse along the normal. 2*m1*m2/(m1+m2) == 2/(1/m1 + 1/m2)
+	float Impulse =	2.0f / (InverseMass1 + InverseMass2) * FVector::DotProduct(RelativeVelocity, CollisionNormal);
 
 
 	// Update velocities
-	const float V1RestitutionCoefficient = RigidBody1->GetRestitutionCoefficient(RigidBody2);//		GetRestitutionCoefficient(RigidBody1, RigidBody2);
-	const float V2RestitutionCoefficient = RigidBody2->GetRestitutionCoefficient(RigidBody1);
-	TempVelocity1 += (V1RestitutionCoefficient * Impulse / Mass1) * CollisionNormal;
+	const FSimplePhysicsBodyParams& Params1 = Bodies.Params[BodyIndex1];
+	const FSimplePhysicsBodyParams& Params2 = Bodies.Params[BodyIndex2];
+	const float V1RestitutionCoefficient = Params1.GetRestitutionCoefficient(Params2);
+	const float V2RestitutionCoefficient = Params2.GetRestitutionCoefficient(Params1);
+	TempVelocity1 += (V1RestitutionCoefficient * Impulse * InverseMass1) * CollisionNormal;
 	//TempVelocity1 += ImpulseA * CollisionNormal / Mass1;
-	TempVelocity2 -= (V2RestitutionCoefficient * Impulse / Mass2) * CollisionNormal;
-
+	TempVelocity2 -= (V2RestitutionCoefficient * Impulse * InverseMass2) * CollisionNormal;
 
 
-	USphereComponent* RigidBody1SphereComponent = Cast<USphereComponent>(RigidBody1->UpdatedComponent);
-	USphereComponent* RigidBody2SphereComponent = Cast<USphereComponent>(RigidBody2->UpdatedComponent);
 
-	if (!RigidBody1SphereComponent || !RigidBody2SphereComponent)
+	// Angular response is only computed for sphere RigidBodies
+	if (Bodies.Radii[BodyIndex1] <= 0.f || Bodies.Radii[BodyIndex2] <= 0.f)
 	{
 		UE_LOG(LogTemp, Warning, TEXT("Faile"));
 		return false;
 	}
 
-	const FVector LeverArm1 = Hit.ImpactPoint - RigidBody1SphereComponent->GetComponentLocation();
-	const FVector LeverArm2 = Hit.ImpactPoint - RigidBody2SphereComponent->GetComponentLocation();
+	const FVector LeverArm1 = Hit.ImpactPoint - Location1;
+	const FVector LeverArm2 = Hit.ImpactPoint - Location2;
 
 	const FVector AngularDirection1 = -FVector::CrossProduct(LeverArm1, CollisionNormal).GetSafeNormal();
 	const FVector AngularDirection2 = FVector::CrossProduct(LeverArm2, CollisionNormal).GetSafeNormal();
 
-	float AngularImpulseMagnitude1 = FVector::DotProduct(LeverArm1, CollisionNormal) / RigidBody1->GetMomentOfInertia();
-	float AngularImpulseMagnitude2 = FVector::DotProduct(LeverArm2, CollisionNormal) / RigidBody2->GetMomentOfInertia();
+	float AngularImpulseMagnitude1 = FVector::DotProduct(LeverArm1, CollisionNormal) * Bodies.InverseMomentsOfInertia[BodyIndex1];
+	float AngularImpulseMagnitude2 = FVector::DotProduct(LeverArm2, CollisionNormal) * Bodies.InverseMomentsOfInertia[BodyIndex2];
 	//UE_LOG(LogTemp, Warning, TEXT("AngularImpulseMagnitude1: %f"), AngularImpulseMagnitude1);
 
-	FVector AngularVelocity1 = RigidBody1->AngularVelocity + (AngularImpulseMagnitude1 * AngularDirection1);
-	FVector AngularVelocity2 = RigidBody2->AngularVelocity + (AngularImpulseMagnitude2 * AngularDirection2);
+	FVector AngularVelocity1 = Bodies.AngularVelocities[BodyIndex1] + (AngularImpulseMagnitude1 * AngularDirection1);
+	FVector AngularVelocity2 = Bodies.AngularVelocities[BodyIndex2] + (AngularImpulseMagnitude2 * AngularDirection2);
 
 	RigidBody1MovementData.Set(TempVelocity1, AngularVelocity1);
 	RigidBody2MovementData.Set(TempVelocity2, AngularVelocity2);
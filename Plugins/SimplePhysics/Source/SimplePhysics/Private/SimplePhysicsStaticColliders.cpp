@@ -0,0 +1,374 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SimplePhysicsStaticColliders.h"
+
+#include "GameFramework/Actor.h"
+
+
+namespace SimplePhysicsStaticColliders
+{
+	/** Distance in cm spheres stop short of a collider, so the following move does not start touching it */
+	static const float ContactSkin = 0.1f;
+}
+
+
+void FSimplePhysicsStaticColliderSet::AddPlane(const FTransform& Transform, const FBox2D& LocalBounds, AActor* SourceActor)
+{
+	const FVector2D LocalCenter = LocalBounds.GetCenter();
+
+	FSimplePhysicsStaticPlane& Plane = Planes.AddDefaulted_GetRef();
+	Plane.Center = Transform.TransformPosition(FVector(0.f, LocalCenter.X, LocalCenter.Y));
+	Plane.Normal = Transform.GetUnitAxis(EAxis::X);
+	Plane.AxisU = Transform.GetUnitAxis(EAxis::Y);
+	Plane.AxisV = Transform.GetUnitAxis(EAxis::Z);
+
+	const FVector Scale = Transform.GetScale3D().GetAbs();
+	Plane.HalfExtents = LocalBounds.GetExtent() * FVector2D(Scale.Y, Scale.Z);
+	Plane.SourceActor = SourceActor;
+}
+
+
+void FSimplePhysicsStaticColliderSet::AddBox(const FTransform& Transform, const FBox& LocalBounds, AActor* SourceActor)
+{
+	FSimplePhysicsStaticBox& Box = Boxes.AddDefaulted_GetRef();
+	Box.Center = Transform.TransformPosition(LocalBounds.GetCenter());
+	Box.Rotation = Transform.GetRotation();
+	Box.HalfExtents = LocalBounds.GetExtent() * Transform.GetScale3D().GetAbs();
+	Box.SourceActor = SourceActor;
+}
+
+
+void FSimplePhysicsStaticColliderSet::Reset()
+{
+	Planes.Reset();
+	Boxes.Reset();
+}
+
+
+void FSimplePhysicsStaticColliderSet::Serialize(FArchive& Ar)
+{
+	int32 NumPlanes = Planes.Num();
+	Ar << NumPlanes;
+	if (Ar.IsLoading())
+	{
+		Planes.SetNum(NumPlanes);
+	}
+
+	for (FSimplePhysicsStaticPlane& Plane : Planes)
+	{
+		Ar << Plane.Center << Plane.Normal << Plane.AxisU << Plane.AxisV << Plane.HalfExtents;
+	}
+
+	int32 NumBoxes = Boxes.Num();
+	Ar << NumBoxes;
+	if (Ar.IsLoading())
+	{
+		Boxes.SetNum(NumBoxes);
+	}
+
+	for (FSimplePhysicsStaticBox& Box : Boxes)
+	{
+		Ar << Box.Center << Box.Rotation << Box.HalfExtents;
+	}
+}
+
+
+bool FSimplePhysicsStaticColliderSet::SweepSphere(const FVector& Start, const FVector& Move, float Radius, FHitResult& OutHit) const
+{
+	float FirstTime = TNumericLimits<float>::Max();
+	FVector FirstNormal(FVector::ZeroVector);
+	FVector FirstImpactPoint(FVector::ZeroVector);
+	AActor* FirstActor = nullptr;
+
+	float Time;
+	FVector Normal, ImpactPoint;
+
+	for (const FSimplePhysicsStaticPlane& Plane : Planes)
+	{
+		if (SweepSpherePlane(Plane, Start, Move, Radius, Time, Normal, ImpactPoint) && Time < FirstTime)
+		{
+			FirstTime = Time;
+			FirstNormal = Normal;
+			FirstImpactPoint = ImpactPoint;
+			FirstActor = Plane.SourceActor.Get();
+		}
+	}
+
+	for (const FSimplePhysicsStaticBox& Box : Boxes)
+	{
+		if (SweepSphereBox(Box, Start, Move, Radius, Time, Normal, ImpactPoint) && Time < FirstTime)
+		{
+			FirstTime = Time;
+			FirstNormal = Normal;
+			FirstImpactPoint = ImpactPoint;
+			FirstActor = Box.SourceActor.Get();
+		}
+	}
+
+	if (FirstTime > 1.f)
+	{
+		return false;
+	}
+
+	const float MoveSize = Move.Size();
+	if (FirstTime > 0.f && MoveSize > UE_KINDA_SMALL_NUMBER)
+	{
+		FirstTime = FMath::Max(FirstTime - SimplePhysicsStaticColliders::ContactSkin / MoveSize, 0.f);
+	}
+
+	OutHit = FHitResult(FirstTime);
+	OutHit.bBlockingHit = true;
+	OutHit.Location = Start + Move * FirstTime;
+	OutHit.ImpactPoint = FirstImpactPoint;
+	OutHit.Normal = FirstNormal;
+	OutHit.ImpactNormal = FirstNormal;
+	OutHit.TraceStart = Start;
+	OutHit.TraceEnd = Start + Move;
+	OutHit.Distance = MoveSize * FirstTime;
+
+	if (FirstActor)
+	{
+		OutHit.HitObjectHandle = FActorInstanceHandle(FirstActor);
+	}
+
+	return true;
+}
+
+
+bool FSimplePhysicsStaticColliderSet::ComputePenetration(const FVector& Center, float Radius, FVector& OutAdjustment) const
+{
+	OutAdjustment = FVector::ZeroVector;
+	bool bPenetrating = false;
+
+	for (const FSimplePhysicsStaticPlane& Plane : Planes)
+	{
+		const FVector LocalCenter = Center - Plane.Center;
+		const float Distance = FVector::DotProduct(LocalCenter, Plane.Normal);
+
+		// Planes are one sided, spheres are only pushed back to the front
+		if (Distance >= Radius || Distance < -Radius ||
+			FMath::Abs(FVector::DotProduct(LocalCenter, Plane.AxisU)) > Plane.HalfExtents.X ||
+			FMath::Abs(FVector::DotProduct(LocalCenter, Plane.AxisV)) > Plane.HalfExtents.Y)
+		{
+			continue;
+		}
+
+		OutAdjustment += Plane.Normal * (Radius - Distance + SimplePhysicsStaticColliders::ContactSkin);
+		bPenetrating = true;
+	}
+
+	for (const FSimplePhysicsStaticBox& Box : Boxes)
+	{
+		const FVector LocalCenter = Box.Rotation.UnrotateVector(Center - Box.Center);
+		const FVector ClosestPoint = LocalCenter.BoundToBox(-Box.HalfExtents, Box.HalfExtents);
+		const FVector Offset = LocalCenter - ClosestPoint;
+		const float DistanceSquared = Offset.SizeSquared();
+
+		if (DistanceSquared >= FMath::Square(Radius))
+		{
+			continue;
+		}
+
+		FVector LocalAdjustment;
+		if (DistanceSquared > UE_SMALL_NUMBER)
+		{
+			const float Distance = FMath::Sqrt(DistanceSquared);
+			LocalAdjustment = Offset * ((Radius - Distance + SimplePhysicsStaticColliders::ContactSkin) / Distance);
+		}
+		else
+		{
+			// Center inside the box, push out through the closest face
+			int32 ClosestAxis = 0;
+			float ClosestDistance = TNumericLimits<float>::Max();
+			for (int32 Axis = 0; Axis < 3; ++Axis)
+			{
+				const float Distance = Box.HalfExtents[Axis] - FMath::Abs(LocalCenter[Axis]);
+				if (Distance < ClosestDistance)
+				{
+					ClosestDistance = Distance;
+					ClosestAxis = Axis;
+				}
+			}
+
+			LocalAdjustment = FVector::ZeroVector;
+			LocalAdjustment[ClosestAxis] = (LocalCenter[ClosestAxis] >= 0.f ? 1.f : -1.f) * (ClosestDistance + Radius + SimplePhysicsStaticColliders::ContactSkin);
+		}
+
+		OutAdjustment += Box.Rotation.RotateVector(LocalAdjustment);
+		bPenetrating = true;
+	}
+
+	return bPenetrating;
+}
+
+
+FBox FSimplePhysicsStaticColliderSet::GetBounds() const
+{
+	FBox Bounds(ForceInit);
+
+	for (const FSimplePhysicsStaticPlane& Plane : Planes)
+	{
+		const FVector U = Plane.AxisU * Plane.HalfExtents.X;
+		const FVector V = Plane.AxisV * Plane.HalfExtents.Y;
+		Bounds += Plane.Center + U + V;
+		Bounds += Plane.Center + U - V;
+		Bounds += Plane.Center - U + V;
+		Bounds += Plane.Center - U - V;
+	}
+
+	for (const FSimplePhysicsStaticBox& Box : Boxes)
+	{
+		Bounds += FBox(-Box.HalfExtents, Box.HalfExtents).TransformBy(FTransform(Box.Rotation, Box.Center));
+	}
+
+	return Bounds;
+}
+
+
+bool FSimplePhysicsStaticColliderSet::SweepSpherePlane(const FSimplePhysicsStaticPlane& Plane, const FVector& Start, const FVector& Move, float Radius, float& OutTime, FVector& OutNormal, FVector& OutImpactPoint) const
+{
+	const float MoveAlongNormal = FVector::DotProduct(Move, Plane.Normal);
+	if (MoveAlongNormal >= 0.f)
+	{
+		// Moving away from or parallel to the plane
+		return false;
+	}
+
+	const float StartDistance = FVector::DotProduct(Start - Plane.Center, Plane.Normal);
+	if (StartDistance < -Radius)
+	{
+		// Behind the plane
+		return false;
+	}
+
+	float Time = 0.f;
+	if (StartDistance > Radius)
+	{
+		if (StartDistance + MoveAlongNormal > Radius)
+		{
+			return false;
+		}
+
+		Time = (StartDistance - Radius) / -MoveAlongNormal;
+	}
+
+	// Contact point is the sphere center projected on the plane, it has to be inside the plane bounds
+	const FVector Center = Start + Move * Time;
+	const FVector ImpactPoint = Center - Plane.Normal * FVector::DotProduct(Center - Plane.Center, Plane.Normal);
+	const FVector LocalImpactPoint = ImpactPoint - Plane.Center;
+
+	if (FMath::Abs(FVector::DotProduct(LocalImpactPoint, Plane.AxisU)) > Plane.HalfExtents.X ||
+		FMath::Abs(FVector::DotProduct(LocalImpactPoint, Plane.AxisV)) > Plane.HalfExtents.Y)
+	{
+		return false;
+	}
+
+	OutTime = Time;
+	OutNormal = Plane.Normal;
+	OutImpactPoint = ImpactPoint;
+	return true;
+}
+
+
+bool FSimplePhysicsStaticColliderSet::SweepSphereBox(const FSimplePhysicsStaticBox& Box, const FVector& Start, const FVector& Move, float Radius, float& OutTime, FVector& OutNormal, FVector& OutImpactPoint) const
+{
+	const FVector LocalStart = Box.Rotation.UnrotateVector(Start - Box.Center);
+	const FVector LocalMove = Box.Rotation.UnrotateVector(Move);
+
+	// Sweep the sphere center against the box grown by the radius. Corners are treated as square, which is close enough for bouncing
+	const FVector Extent = Box.HalfExtents + FVector(Radius);
+
+	float EnterTime = -TNumericLimits<float>::Max();
+	float ExitTime = TNumericLimits<float>::Max();
+	FVector LocalNormal(FVector::ZeroVector);
+
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		const float AxisStart = LocalStart[Axis];
+		const float AxisMove = LocalMove[Axis];
+
+		if (FMath::Abs(AxisMove) < UE_SMALL_NUMBER)
+		{
+			if (FMath::Abs(AxisStart) > Extent[Axis])
+			{
+				return false;
+			}
+
+			continue;
+		}
+
+		const float Time1 = (-Extent[Axis] - AxisStart) / AxisMove;
+		const float Time2 = (Extent[Axis] - AxisStart) / AxisMove;
+		const float NearTime = FMath::Min(Time1, Time2);
+
+		if (NearTime > EnterTime)
+		{
+			EnterTime = NearTime;
+			LocalNormal = FVector::ZeroVector;
+			LocalNormal[Axis] = (AxisMove > 0.f) ? -1.f : 1.f;
+		}
+
+		ExitTime = FMath::Min(ExitTime, FMath::Max(Time1, Time2));
+	}
+
+	if (EnterTime > ExitTime || ExitTime < 0.f || EnterTime > 1.f)
+	{
+		return false;
+	}
+
+	FVector LocalImpactPoint;
+	float Time = 0.f;
+
+	if (EnterTime >= 0.f)
+	{
+		Time = EnterTime;
+		const FVector LocalCenter = LocalStart + LocalMove * Time;
+		LocalImpactPoint = LocalCenter.BoundToBox(-Box.HalfExtents, Box.HalfExtents);
+	}
+	else
+	{
+		// Starting inside the grown box, check the sphere actually touches the box
+		LocalImpactPoint = LocalStart.BoundToBox(-Box.HalfExtents, Box.HalfExtents);
+		const FVector Offset = LocalStart - LocalImpactPoint;
+
+		if (Offset.SizeSquared() > FMath::Square(Radius))
+		{
+			return false;
+		}
+
+		if (Offset.IsNearlyZero())
+		{
+			// Center inside the box, push out through the closest face
+			int32 ClosestAxis = 0;
+			float ClosestDistance = TNumericLimits<float>::Max();
+			for (int32 Axis = 0; Axis < 3; ++Axis)
+			{
+				const float Distance = Box.HalfExtents[Axis] - FMath::Abs(LocalStart[Axis]);
+				if (Distance < ClosestDistance)
+				{
+					ClosestDistance = Distance;
+					ClosestAxis = Axis;
+				}
+			}
+
+			LocalNormal = FVector::ZeroVector;
+			LocalNormal[ClosestAxis] = (LocalStart[ClosestAxis] >= 0.f) ? 1.f : -1.f;
+			LocalImpactPoint[ClosestAxis] = LocalNormal[ClosestAxis] * Box.HalfExtents[ClosestAxis];
+		}
+		else
+		{
+			LocalNormal = Offset.GetUnsafeNormal();
+		}
+
+		if (FVector::DotProduct(LocalMove, LocalNormal) >= 0.f)
+		{
+			return false;
+		}
+	}
+
+	OutTime = Time;
+	OutNormal = Box.Rotation.RotateVector(LocalNormal);
+	OutImpactPoint = Box.Center + Box.Rotation.RotateVector(LocalImpactPoint);
+	return true;
+}
@@ -0,0 +1,30 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SimplePhysicsStats.h"
+
+
+DEFINE_STAT(STAT_SimplePhysics_Tick);
+DEFINE_STAT(STAT_SimplePhysics_Register);
+DEFINE_STAT(STAT_SimplePhysics_Integrate);
+DEFINE_STAT(STAT_SimplePhysics_Collide);
+DEFINE_STAT(STAT_SimplePhysics_Resolve);
+DEFINE_STAT(STAT_SimplePhysics_Sweep);
+DEFINE_STAT(STAT_SimplePhysics_Writeback);
+DEFINE_STAT(STAT_SimplePhysics_DispatchEvents);
+DEFINE_STAT(STAT_SimplePhysics_Query);
+
+DEFINE_STAT(STAT_SimplePhysics_SimulatingBodies);
+DEFINE_STAT(STAT_SimplePhysics_SleepingBodies);
+DEFINE_STAT(STAT_SimplePhysics_AddedBodies);
+DEFINE_STAT(STAT_SimplePhysics_RemovedBodies);
+DEFINE_STAT(STAT_SimplePhysics_Contacts);
+DEFINE_STAT(STAT_SimplePhysics_Iterations);
+DEFINE_STAT(STAT_SimplePhysics_Aborts);
+DEFINE_STAT(STAT_SimplePhysics_Steps);
+DEFINE_STAT(STAT_SimplePhysics_Queries);
+DEFINE_STAT(STAT_SimplePhysics_QualityLevel);
+DEFINE_STAT(STAT_SimplePhysics_BodyStoreMemory);
+DEFINE_STAT(STAT_SimplePhysics_SideTableMemory);
+
+UE_TRACE_CHANNEL_DEFINE(SimplePhysicsChannel);
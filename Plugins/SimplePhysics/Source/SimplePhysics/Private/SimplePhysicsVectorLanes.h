@@ -0,0 +1,130 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+/**
+ * Helpers for the batched solver kernels. A batch holds one body or body pair per lane of a VectorRegister4Double,
+ * so each vector instruction works on the whole batch at once.
+ */
+namespace SimplePhysicsLanes
+{
+	/** Number of bodies or pairs processed together */
+	static constexpr int32 Width = 4;
+
+	/** Vectors of Width bodies, with each component in its own register */
+	struct FVectorLanes
+	{
+		VectorRegister4Double X;
+		VectorRegister4Double Y;
+		VectorRegister4Double Z;
+	};
+
+
+	FORCEINLINE VectorRegister4Double Splat(double Value)
+	{
+		return MakeVectorRegisterDouble(Value, Value, Value, Value);
+	}
+
+
+	/** Gather Array[Indices[Lane]] into each lane */
+	template<typename ElementType>
+	FORCEINLINE VectorRegister4Double Load(const TArray<ElementType>& Array, const int32* Indices)
+	{
+		return MakeVectorRegisterDouble(Array[Indices[0]], Array[Indices[1]], Array[Indices[2]], Array[Indices[3]]);
+	}
+
+
+	/** Gather a member of Array[Indices[Lane]] into each lane */
+	template<typename ElementType, typename MemberType>
+	FORCEINLINE VectorRegister4Double Load(const TArray<ElementType>& Array, MemberType ElementType::* Member, const int32* Indices)
+	{
+		return MakeVectorRegisterDouble(Array[Indices[0]].*Member, Array[Indices[1]].*Member, Array[Indices[2]].*Member, Array[Indices[3]].*Member);
+	}
+
+
+	FORCEINLINE FVectorLanes MakeVectors(const FVector& V0, const FVector& V1, const FVector& V2, const FVector& V3)
+	{
+		return FVectorLanes{
+			MakeVectorRegisterDouble(V0.X, V1.X, V2.X, V3.X),
+			MakeVectorRegisterDouble(V0.Y, V1.Y, V2.Y, V3.Y),
+			MakeVectorRegisterDouble(V0.Z, V1.Z, V2.Z, V3.Z) };
+	}
+
+
+	/** Gather the vectors Array[Indices[Lane]] into each lane */
+	FORCEINLINE FVectorLanes LoadVectors(const TArray<FVector>& Array, const int32* Indices)
+	{
+		return MakeVectors(Array[Indices[0]], Array[Indices[1]], Array[Indices[2]], Array[Indices[3]]);
+	}
+
+
+	/** Gather a vector member of Array[Indices[Lane]] into each lane */
+	template<typename ElementType>
+	FORCEINLINE FVectorLanes LoadVectors(const TArray<ElementType>& Array, FVector ElementType::* Member, const int32* Indices)
+	{
+		return MakeVectors(Array[Indices[0]].*Member, Array[Indices[1]].*Member, Array[Indices[2]].*Member, Array[Indices[3]].*Member);
+	}
+
+
+	/** Write each lane back to a vector per lane */
+	FORCEINLINE void StoreVectors(const FVectorLanes& Lanes, FVector* OutVectors)
+	{
+		alignas(32) double X[Width];
+		alignas(32) double Y[Width];
+		alignas(32) double Z[Width];
+		VectorStoreAligned(Lanes.X, X);
+		VectorStoreAligned(Lanes.Y, Y);
+		VectorStoreAligned(Lanes.Z, Z);
+
+		for (int32 Lane = 0; Lane < Width; ++Lane)
+		{
+			OutVectors[Lane] = FVector(X[Lane], Y[Lane], Z[Lane]);
+		}
+	}
+
+
+	FORCEINLINE FVectorLanes Subtract(const FVectorLanes& A, const FVectorLanes& B)
+	{
+		return FVectorLanes{ VectorSubtract(A.X, B.X), VectorSubtract(A.Y, B.Y), VectorSubtract(A.Z, B.Z) };
+	}
+
+
+	FORCEINLINE FVectorLanes Scale(const FVectorLanes& A, const VectorRegister4Double& S)
+	{
+		return FVectorLanes{ VectorMultiply(A.X, S), VectorMultiply(A.Y, S), VectorMultiply(A.Z, S) };
+	}
+
+
+	/** A * S + B */
+	FORCEINLINE FVectorLanes ScaleAdd(const FVectorLanes& A, const VectorRegister4Double& S, const FVectorLanes& B)
+	{
+		return FVectorLanes{ VectorMultiplyAdd(A.X, S, B.X), VectorMultiplyAdd(A.Y, S, B.Y), VectorMultiplyAdd(A.Z, S, B.Z) };
+	}
+
+
+	FORCEINLINE VectorRegister4Double Dot(const FVectorLanes& A, const FVectorLanes& B)
+	{
+		return VectorMultiplyAdd(A.X, B.X, VectorMultiplyAdd(A.Y, B.Y, VectorMultiply(A.Z, B.Z)));
+	}
+
+
+	/**
+	 * Same as FVector::GetClampedToMaxSize() in every lane where MaxSize > 0. Lanes with MaxSize 0 are not limited.
+	 */
+	FORCEINLINE FVectorLanes ClampToMaxSize(const FVectorLanes& A, const VectorRegister4Double& MaxSize)
+	{
+		const VectorRegister4Double SizeSquared = Dot(A, A);
+		const VectorRegister4Double ClampMask = VectorBitwiseAnd(
+			VectorCompareGT(MaxSize, GlobalVectorConstants::DoubleZero),
+			VectorCompareGT(SizeSquared, VectorMultiply(MaxSize, MaxSize)));
+
+		// SizeSquared is only 0 in lanes that are not clamped, keep the division finite anyway
+		const VectorRegister4Double SafeSize = VectorSqrt(VectorMax(SizeSquared, Splat(UE_DOUBLE_SMALL_NUMBER)));
+		const VectorRegister4Double ClampScale = VectorSelect(ClampMask, VectorDivide(MaxSize, SafeSize), GlobalVectorConstants::DoubleOne);
+
+		return Scale(A, ClampScale);
+	}
+}
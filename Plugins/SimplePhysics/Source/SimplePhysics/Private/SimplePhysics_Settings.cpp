@@ -8,4 +8,41 @@ USimplePhysics_Settings::USimplePhysics_Settings(const FObjectInitializer& obj)
 	GravityAcceleration = 980.f;
 	MaxSimulationIterations = 3;
 	MinimumSimulationVelocity = 0.01f;
+	WakeContactTolerance = 1.f;
+	ContactSolverIterations = 4;
+	bKeepLastHitResults = true;
+	bWarmStartContacts = true;
+	ContactWarmStartFactor = 0.9f;
+	RestingContactSpeed = 50.f;
+	RestingContactLifetimeSteps = 4;
+	bDepenetrateStuckBodies = true;
+	MaxDepenetrationDistance = 25.f;
+	bDetectEscapedBodies = true;
+	EscapedBodyMargin = 50.f;
+	BroadphaseCellSize = 0.f;
+	RigidBodyObjectType = ECollisionChannel::ECC_GameTraceChannel3;
+	bTeleportContactFreeBodies = true;
+	bParallelIntegration = true;
+	ParallelIntegrationBatchSize = 32;
+	bAsyncStepping = false;
+	bUseFixedTimestep = false;
+	FixedTimestep = 1.f / 90.f;
+	MaxStepsPerFrame = 4;
+	bInterpolateFixedSteps = true;
+	bUseSubstepping = false;
+	MaxSubsteps = 4;
+	SubstepMaxTravelFraction = 0.5f;
+	bUseSignificance = false;
+	SignificanceFullRateDistance = 150.f;
+	SignificanceHalfRateDistance = 400.f;
+	bReduceRateOutOfView = true;
+	bUseFrameBudget = false;
+	FrameBudgetMilliseconds = 2.f;
+	FrameBudgetQualityLevels = 4;
+	FrameBudgetRecoverFraction = 0.75f;
+	FrameBudgetRecoverFrames = 60;
+	LowestQualitySimulationIterations = 1;
+	LowestQualityContactSolverIterations = 1;
+	LowestQualityMaxSubsteps = 1;
+	LowestQualityMinimumSimulationVelocity = 5.f;
 }
@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "SimplePhysics.h"
+#include "SimplePhysicsBodyProfile.generated.h"
+
+
+/**
+ * Tuning values shared by every RigidBody of an archetype, such as all fragments of an asteroid type.
+ * RigidBodies with a profile read their tuning values from it instead of their own properties, while mass
+ * and moment of inertia stay per RigidBody as they usually depend on its scale.
+ */
+UCLASS(BlueprintType)
+class SIMPLEPHYSICS_API USimplePhysicsBodyProfile : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+
+	USimplePhysicsBodyProfile();
+
+	/** Should RigidBodies simulate acceleration due to gravity */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	bool bUseGravity;
+
+	/** Custom gravity scale. Set to 0 for no gravity */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	float GravityScale;
+
+	/** Start simulating when hit by another RigidBody */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	bool bEnableSimulationOnRigidBodyCollision;
+
+	/** Coefficient of friction when sliding along a surface. Normal Range is [0,1], where 0 = No Friction and 1 = high friction */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	float Friction;
+
+	/** When bounce angle affects friction, apply at least this fraction of normal friction */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	float MinFrictionFraction;
+
+	/** Percentage of velocity maintained after the bounce in the direction of the normal of impact (coefficient of restitution) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	float Bounciness;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	float LinearDamping;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	float AngularDamping;
+
+	/** Max Speed (Linear Velocity). Set to 0 for no max speed limit */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	float MaxSpeed;
+
+	/** Max Angular Velocity. Set to 0 for no max angular velocity */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	float MaxAngularVelocity;
+
+	/** Determine how to scale Bounciness when colliding with another RigidBody */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	EBounceCombine BounceCombine;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	bool bBounceAngleAffectsFriction;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	float TempScale;
+
+	/** Collision categories RigidBodies with this profile belong to */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Collision", meta = (Bitmask))
+	int32 CollisionCategoryBits;
+
+	/** Collision categories of other RigidBodies these RigidBodies collide with */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Collision", meta = (Bitmask))
+	int32 CollisionMaskBits;
+};
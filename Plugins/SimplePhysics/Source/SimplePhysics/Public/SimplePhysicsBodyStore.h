@@ -0,0 +1,334 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SimplePhysics.h"
+#include "SimplePhysicsBodyStore.generated.h"
+
+class USimplePhysicsRigidBodyComponent;
+
+
+/**
+ * Tuning values of a RigidBody used by the solver. Copied from the USimplePhysicsRigidBodyComponent when the body is added or refreshed.
+ */
+struct SIMPLEPHYSICS_API FSimplePhysicsBodyParams
+{
+	float LinearDamping;
+	float AngularDamping;
+
+	/** Acceleration due to gravity in cm/s^2 with GravityScale applied. 0 when the RigidBody does not use gravity */
+	float GravityZ;
+
+	/** Max Speed (Linear Velocity). 0 for no limit */
+	float MaxSpeed;
+
+	/** Max Angular Velocity. 0 for no limit */
+	float MaxAngularVelocity;
+
+	float Friction;
+	float MinFrictionFraction;
+	float Bounciness;
+	float TempScale;
+	EBounceCombine BounceCombine;
+	bool bBounceAngleAffectsFriction;
+	bool bEnableSimulationOnRigidBodyCollision;
+
+	/** Normal of the plane movement is constrained to. Zero when movement is not constrained */
+	FVector PlaneConstraintNormal;
+
+	FSimplePhysicsBodyParams();
+
+	/** Limit NewVelocity to have a length no greater than MaxSpeed and constrain it to the movement plane */
+	FVector LimitVelocity(FVector NewVelocity) const;
+
+	/** Limit NewAngularVelocity to have a length no greater than MaxAngularVelocity */
+	FVector LimitAngularVelocity(FVector NewAngularVelocity) const;
+
+	/** Constrain a surface normal to the movement plane */
+	FVector ConstrainNormalToPlane(const FVector& Normal) const;
+
+	/** Calculate the RestitutionCoefficient to apply to collision calculations when colliding with another RigidBody */
+	float GetRestitutionCoefficient(const FSimplePhysicsBodyParams& OtherParams) const;
+};
+
+
+/**
+ * Stable reference to a body in FSimplePhysicsBodyStore. Stays valid while bodies are compacted, and becomes stale
+ * instead of pointing at another body once the body is removed.
+ */
+struct FSimplePhysicsBodyHandle
+{
+	int32 Slot;
+	int32 Generation;
+
+	FSimplePhysicsBodyHandle()
+		:
+		Slot(INDEX_NONE),
+		Generation(0)
+	{}
+
+	FSimplePhysicsBodyHandle(int32 InSlot, int32 InGeneration)
+		:
+		Slot(InSlot),
+		Generation(InGeneration)
+	{}
+
+	bool IsValid() const { return Slot != INDEX_NONE; }
+	void Reset() { Slot = INDEX_NONE; Generation = 0; }
+
+	bool operator==(const FSimplePhysicsBodyHandle& Other) const { return Slot == Other.Slot && Generation == Other.Generation; }
+	bool operator!=(const FSimplePhysicsBodyHandle& Other) const { return !(*this == Other); }
+
+	friend uint32 GetTypeHash(const FSimplePhysicsBodyHandle& Handle) { return HashCombine(::GetTypeHash(Handle.Slot), ::GetTypeHash(Handle.Generation)); }
+};
+
+
+/**
+ * Which other bodies a body collides with. Pairs rejected by the filter are dropped by the broadphase before any contact is generated.
+ */
+struct FSimplePhysicsCollisionFilter
+{
+	/** Categories the body belongs to */
+	uint32 CategoryBits;
+
+	/** Categories the body collides with */
+	uint32 MaskBits;
+
+	/** Bodies sharing a non zero IgnoreGroup do not collide with each other until IgnoreGroupEndTime */
+	int32 IgnoreGroup;
+	double IgnoreGroupEndTime;
+
+	FSimplePhysicsCollisionFilter()
+		:
+		CategoryBits(1),
+		MaskBits(MAX_uint32),
+		IgnoreGroup(0),
+		IgnoreGroupEndTime(0.0)
+	{}
+
+	/** Can a body with this filter collide with a body with Other at simulation time Time */
+	bool ShouldCollide(const FSimplePhysicsCollisionFilter& Other, double Time) const
+	{
+		if ((CategoryBits & Other.MaskBits) == 0 || (Other.CategoryBits & MaskBits) == 0)
+		{
+			return false;
+		}
+
+		// Collisions come back as soon as either body leaves the group
+		return IgnoreGroup == 0 || IgnoreGroup != Other.IgnoreGroup || Time >= FMath::Min(IgnoreGroupEndTime, Other.IgnoreGroupEndTime);
+	}
+};
+
+
+/** Change of simulation state requested for a body, applied at the start of the next step */
+enum class ESimplePhysicsPendingSimulation : uint8
+{
+	None,
+	Enable,
+	Disable
+};
+
+
+/**
+ * Free flight movement of a body over one tick, computed before any collision is handled.
+ * Only valid while the body velocities still match StartVelocity and StartAngularVelocity.
+ */
+struct SIMPLEPHYSICS_API FSimplePhysicsIntegrationResult
+{
+	FVector StartVelocity;
+	FVector StartAngularVelocity;
+	FVector MoveDelta;
+	FVector Velocity;
+	FVector AngularVelocity;
+	FVector AngularVelocityDelta;
+
+	FSimplePhysicsIntegrationResult()
+		:
+		StartVelocity(FVector::ZeroVector),
+		StartAngularVelocity(FVector::ZeroVector),
+		MoveDelta(FVector::ZeroVector),
+		Velocity(FVector::ZeroVector),
+		AngularVelocity(FVector::ZeroVector),
+		AngularVelocityDelta(FVector::ZeroVector)
+	{}
+
+	/** Was this result integrated from these velocities */
+	bool IsValidFor(const FVector& InVelocity, const FVector& InAngularVelocity) const
+	{
+		return StartVelocity == InVelocity && StartAngularVelocity == InAngularVelocity;
+	}
+};
+
+
+/**
+ * Structure of arrays store for all RigidBodies known to the solver. USimplePhysicsRigidBodyComponents only hold a handle into the store,
+ * so the integration and collision loops stream through contiguous arrays instead of reading each component.
+ * Handles are resolved to dense indices through a sparse slot array, so add, remove and lookup are all O(1).
+ * Removed bodies keep their dense index until Compact() is called so indices stay valid while the solver is ticking.
+ */
+USTRUCT()
+struct SIMPLEPHYSICS_API FSimplePhysicsBodyStore
+{
+	GENERATED_BODY()
+
+	/** Component owning each body. Null for removed bodies waiting for Compact() */
+	UPROPERTY()
+	TArray<TObjectPtr<USimplePhysicsRigidBodyComponent>> Components;
+
+	TArray<FVector> Positions;
+	TArray<FVector> Velocities;
+	TArray<FVector> AngularVelocities;
+
+	/** Accumulated Force applied each movement update */
+	TArray<FVector> PendingForces;
+
+	/** Accumulated Torque applied each movement update */
+	TArray<FVector> PendingTorques;
+
+	/** Scaled sphere radius. 0 if the UpdatedComponent is not a USphereComponent */
+	TArray<float> Radii;
+
+	TArray<float> InverseMasses;
+	TArray<float> InverseMomentsOfInertia;
+
+	TArray<FSimplePhysicsBodyParams> Params;
+
+	/** Is the body being simulated each tick */
+	TArray<bool> Simulating;
+
+	/** Is the body at rest with simulation enabled. Sleeping bodies are not simulated until woken by a contact or being moved */
+	TArray<bool> Sleeping;
+
+	/** Binding to the TransformUpdated event of the UpdatedComponent while the body is sleeping */
+	TArray<FDelegateHandle> SleepMoveHandles;
+
+	/** Can other bodies collide with this body */
+	TArray<bool> CollisionEnabled;
+
+	/** Categories and ignore group checked for each broadphase pair */
+	TArray<FSimplePhysicsCollisionFilter> CollisionFilters;
+
+	/** Simulation change requested for the body this step */
+	TArray<ESimplePhysicsPendingSimulation> PendingSimulation;
+
+	/** Index of the bounce event queued for the body this frame. INDEX_NONE if the body has not bounced this frame */
+	TArray<int32> BounceEventIndices;
+
+	/** Number of steps between movement updates of the body, chosen by the significance pass. 1 moves the body every step */
+	TArray<uint8> UpdateIntervals;
+
+	/** Last step the body moved in */
+	TArray<int64> LastUpdateSteps;
+
+	/** Slot of each body, the inverse of SlotIndices. INDEX_NONE for removed bodies */
+	TArray<int32> BodySlots;
+
+	FSimplePhysicsBodyStore();
+
+	/** Number of body slots, including removed bodies waiting for Compact() */
+	int32 Num() const { return Components.Num(); }
+
+	/** Number of bodies currently simulating */
+	int32 GetNumSimulating() const { return NumSimulating; }
+
+	/** Number of bodies currently sleeping */
+	int32 GetNumSleeping() const { return NumSleeping; }
+
+	bool IsValidIndex(int32 Index) const { return Components.IsValidIndex(Index) && Components[Index] != nullptr; }
+
+	/** Bytes allocated by all arrays of the store, including slack */
+	SIZE_T GetAllocatedSize() const;
+
+	/** Get the handle of the body at Index */
+	FSimplePhysicsBodyHandle GetHandle(int32 Index) const;
+
+	/** Get the index of a body. INDEX_NONE if Handle is stale */
+	int32 FindIndex(const FSimplePhysicsBodyHandle& Handle) const;
+
+	/** Get the index of the body of Component. INDEX_NONE if Component has no body */
+	int32 FindIndex(const USimplePhysicsRigidBodyComponent* Component) const;
+
+	/** Add a body for Component and read its current state. Returns the new body index */
+	int32 Add(USimplePhysicsRigidBodyComponent* Component);
+
+	/** Remove a body. The slot is released on the next call to Compact() */
+	void Remove(int32 Index);
+
+	/** Release all removed slots. Will change the index of moved bodies. Returns true if any slot was released */
+	bool Compact();
+
+	void SetSimulating(int32 Index, bool bSimulating);
+	void SetSleeping(int32 Index, bool bSleeping);
+
+	/** Copy tuning values, mass, moment of inertia and collision categories from the component */
+	void RefreshParams(int32 Index);
+
+	/** Copy location, radius and collision state from the component. Returns true if any of it changed */
+	bool ReadComponentState(int32 Index);
+
+	/** Copy only the collision state from the component, for bodies whose location can not change. Returns true if it changed */
+	bool ReadCollisionState(int32 Index);
+
+	/** Copy velocities to the component so they are visible to the rest of the engine */
+	void WriteComponentState(int32 Index) const;
+
+	void SetVelocity(int32 Index, const FVector& NewVelocity);
+	void SetAngularVelocity(int32 Index, const FVector& NewAngularVelocity);
+	void SetMovementData(int32 Index, const FMovementData& MovementData);
+
+	/** Can the bodies at Index and OtherIndex collide at simulation time Time */
+	bool ShouldCollide(int32 Index, int32 OtherIndex, double Time) const { return CollisionFilters[Index].ShouldCollide(CollisionFilters[OtherIndex], Time); }
+
+	bool HasPendingForce(int32 Index) const { return PendingForces[Index].SquaredLength() > 0.f; }
+
+	/** Compute the acceleration that will be applied */
+	FVector ComputeAcceleration(int32 Index, const FVector& InitialVelocity) const;
+
+	/** Given an initial velocity and a time step, compute a new velocity by applying ComputeAcceleration() */
+	FVector ComputeVelocity(int32 Index, const FVector& InitialVelocity, float DeltaTime) const;
+
+	/** Compute the distance the body should move given time, at a given a velocity */
+	FVector ComputeMoveDelta(int32 Index, const FVector& InVelocity, float DeltaTime) const;
+
+	FVector ComputeAngularAcceleration(int32 Index, const FVector& InitialAngularVelocity) const;
+	FVector ComputeAngularVelocity(int32 Index, const FVector& InitialAngularVelocity, float DeltaTime) const;
+	FVector ComputeAngularVelocityDelta(int32 Index, const FVector& InAngularVelocity, float DeltaTime) const;
+
+	/** Integrate the body over DeltaTime without moving it. Only reads the store, so can be called for different bodies in parallel */
+	void Integrate(int32 Index, float DeltaTime, FSimplePhysicsIntegrationResult& OutResult) const;
+
+	/**
+	 * Same as Integrate() for NumIndices bodies, four bodies at a time in vector registers.
+	 * @param	DeltaTimes		Time to integrate each body over, indexed by body index
+	 * @param	OutResults		Results indexed by body index, only the entries of BodyIndices are written
+	 */
+	void IntegrateBatch(const int32* BodyIndices, int32 NumIndices, const float* DeltaTimes, FSimplePhysicsIntegrationResult* OutResults) const;
+
+	/** Call after moving the body by Result.MoveDelta. Same as UpdateMovementVelocity() using the already integrated velocities */
+	void ApplyIntegrationResult(int32 Index, const FSimplePhysicsIntegrationResult& Result);
+
+	/**
+	 * Call after moving the body. Will change Velocity and AngularVelocity based on PendingForces, Gravity and Damping,
+	 * unless they were already changed during the move.
+	 */
+	void UpdateMovementVelocity(int32 Index, const FVector& OldVelocity, const FVector& OldAngularVelocity, float DeltaTime);
+
+private:
+
+	int32 NumSimulating;
+	int32 NumSleeping;
+
+	/** Number of removed bodies waiting for Compact() */
+	int32 NumRemoved;
+
+	/** Dense index of the body in each slot. INDEX_NONE for free slots */
+	TArray<int32> SlotIndices;
+
+	/** Incremented each time a slot is freed, so handles to removed bodies become stale */
+	TArray<int32> SlotGenerations;
+
+	TArray<int32> FreeSlots;
+
+	void RemoveAtSwap(int32 Index);
+};
@@ -0,0 +1,151 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+/**
+ * Two broadphase entries whose bounds overlap. First is always less than Second.
+ */
+struct FSimplePhysicsCandidatePair
+{
+	int32 First;
+	int32 Second;
+
+	FSimplePhysicsCandidatePair()
+		:
+		First(INDEX_NONE),
+		Second(INDEX_NONE)
+	{}
+
+	FSimplePhysicsCandidatePair(int32 InFirst, int32 InSecond)
+		:
+		First(FMath::Min(InFirst, InSecond)),
+		Second(FMath::Max(InFirst, InSecond))
+	{}
+};
+
+
+/**
+ * Contact between two moving spheres found by the solver. Time is the fraction of the step where the spheres first touch.
+ */
+struct FSimplePhysicsContact
+{
+	int32 BodyIndex;
+	int32 OtherBodyIndex;
+	float Time;
+
+	/** Contact normal at the time of impact, pointing from OtherBodyIndex to BodyIndex */
+	FVector Normal;
+
+	/** Relative normal velocity the contact solver drives the bodies towards. Positive when separating */
+	float TargetNormalVelocity;
+
+	/** Impulse applied along Normal by the contact solver so far. Never negative, contacts only push */
+	float NormalImpulse;
+
+	/** Do both bodies respond to this contact. False if OtherBodyIndex is treated as static */
+	bool bSolve;
+
+	FSimplePhysicsContact()
+		:
+		BodyIndex(INDEX_NONE),
+		OtherBodyIndex(INDEX_NONE),
+		Time(1.f),
+		Normal(FVector::ZeroVector),
+		TargetNormalVelocity(0.f),
+		NormalImpulse(0.f),
+		bSolve(false)
+	{}
+
+	FSimplePhysicsContact(int32 InBodyIndex, int32 InOtherBodyIndex, float InTime, const FVector& InNormal)
+		:
+		BodyIndex(InBodyIndex),
+		OtherBodyIndex(InOtherBodyIndex),
+		Time(InTime),
+		Normal(InNormal),
+		TargetNormalVelocity(0.f),
+		NormalImpulse(0.f),
+		bSolve(false)
+	{}
+
+	/** Order by time of impact. Ties are ordered by body index so the order does not depend on the broadphase */
+	bool operator<(const FSimplePhysicsContact& Other) const
+	{
+		if (Time != Other.Time)
+		{
+			return Time < Other.Time;
+		}
+
+		return (BodyIndex != Other.BodyIndex) ? BodyIndex < Other.BodyIndex : OtherBodyIndex < Other.OtherBodyIndex;
+	}
+};
+
+
+/**
+ * Uniform grid spatial hash over axis aligned bounds. Rebuilt each tick by USimplePhysicsSolver to find
+ * RigidBodies that may collide without querying the engine collision scene.
+ */
+class SIMPLEPHYSICS_API FSimplePhysicsSpatialHash
+{
+public:
+
+	FSimplePhysicsSpatialHash();
+
+	/** Remove all entries and set the cell size used by following calls to Insert. Allocations are kept for the next build */
+	void Reset(float NewCellSize);
+
+	/** Insert Bounds for entry Index. Each Index should only be inserted once per build */
+	void Insert(int32 Index, const FBox& Bounds);
+
+	/** Append every pair of inserted entries with overlapping bounds. Each pair is only reported once */
+	void GatherCandidatePairs(TArray<FSimplePhysicsCandidatePair>& OutPairs) const;
+
+	/** Append every inserted entry with bounds overlapping Bounds. Each entry is only reported once */
+	void Query(const FBox& Bounds, TArray<int32>& OutIndices) const;
+
+	/**
+	 * Append every inserted entry with bounds overlapping a sphere of Radius moving from Start to End, sorted by index.
+	 * Long segments are split so only cells near the segment are visited instead of every cell in its bounds.
+	 */
+	void QuerySegment(const FVector& Start, const FVector& End, float Radius, TArray<int32>& OutIndices) const;
+
+	/** Are there no inserted entries */
+	bool IsEmpty() const { return CellEntries.Num() == 0; }
+
+	/** Get the size of a single grid cell in cm */
+	float GetCellSize() const { return CellSize; }
+
+private:
+
+	struct FCellEntry
+	{
+		/** Index of the inserted entry */
+		int32 Index;
+
+		/** Next entry in the same cell, INDEX_NONE if this is the last */
+		int32 Next;
+	};
+
+	/** Most pieces a segment query is split into. Longer pieces are used for very long segments */
+	static const int32 MAX_SEGMENT_PIECES;
+
+	/** Get the grid cell containing Location */
+	FIntVector GetCell(const FVector& Location) const;
+
+	float CellSize;
+	float InvCellSize;
+
+	/** First FCellEntry for each occupied grid cell */
+	TMap<FIntVector, int32> CellHeads;
+
+	/** Linked lists of entries for each occupied grid cell */
+	TArray<FCellEntry> CellEntries;
+
+	/** Bounds for each inserted entry, indexed by entry Index */
+	TArray<FBox> EntryBounds;
+
+	/** Lowest grid cell touched by each inserted entry. Used so overlapping pairs are only reported from a single shared cell */
+	TArray<FIntVector> EntryMinCells;
+};
@@ -0,0 +1,93 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SimplePhysicsStaticColliders.h"
+
+
+/** Kind of input recorded by USimplePhysicsSolver */
+enum class ESimplePhysicsInputType : uint8
+{
+	/** End of the inputs of a frame. Scalar is the frame DeltaTime */
+	Frame,
+
+	/** First input of a body. BodyId indexes BodyPaths */
+	AddBody,
+	RemoveBody,
+
+	/** Scalar is 1 to enable and 0 to disable. Value is the location of the body */
+	SetSimulationEnabled,
+	WakeBody,
+	RefreshBody,
+	AddForce,
+	AddTorque,
+	SetVelocity,
+	SetAngularVelocity,
+
+	/** Value is the impulse. Scalar is 1 if the impulse is a velocity change */
+	AddImpulse,
+
+	/** Value.X is the group id and Scalar the duration */
+	SetIgnoreGroup,
+
+	/** BodyId indexes StaticColliderSets */
+	SetStaticColliders,
+
+	/** BodyId indexes SimulationBounds */
+	SetSimulationBounds
+};
+
+
+/**
+ * Single input to the solver.
+ */
+struct FSimplePhysicsInputRecord
+{
+	ESimplePhysicsInputType Type;
+	int32 BodyId;
+	FVector Value;
+	float Scalar;
+
+	FSimplePhysicsInputRecord()
+		:
+		Type(ESimplePhysicsInputType::Frame),
+		BodyId(INDEX_NONE),
+		Value(FVector::ZeroVector),
+		Scalar(0.f)
+	{}
+
+	FSimplePhysicsInputRecord(ESimplePhysicsInputType InType, int32 InBodyId, const FVector& InValue = FVector::ZeroVector, float InScalar = 0.f)
+		:
+		Type(InType),
+		BodyId(InBodyId),
+		Value(InValue),
+		Scalar(InScalar)
+	{}
+
+	/** Only the fields used by Type are written */
+	friend FArchive& operator<<(FArchive& Ar, FSimplePhysicsInputRecord& Record);
+};
+
+
+/**
+ * Every input that affected a USimplePhysicsSolver session, in the order the solver received it.
+ * Replaying the recording drives the solver through the same steps without the game code that caused them.
+ */
+struct SIMPLEPHYSICS_API FSimplePhysicsInputRecording
+{
+	TArray<FSimplePhysicsInputRecord> Records;
+
+	/** Path of each recorded RigidBody component relative to its world, indexed by body id */
+	TArray<FString> BodyPaths;
+
+	TArray<FSimplePhysicsStaticColliderSet> StaticColliderSets;
+	TArray<FBox> SimulationBounds;
+
+	void Reset();
+
+	bool SaveToFile(const FString& Filename);
+	bool LoadFromFile(const FString& Filename);
+
+	void Serialize(FArchive& Ar);
+};
@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SimplePhysicsBodyStore.h"
+
+
+/**
+ * Sphere moving from Start to End, tested against RigidBodies by USimplePhysicsSolver::SweepBatch(). A Radius of 0 is a ray.
+ */
+struct FSimplePhysicsSweepQuery
+{
+	FVector Start;
+	FVector End;
+	float Radius;
+
+	/** Only RigidBodies with a collision category in CollisionMask are hit */
+	uint32 CollisionMask;
+
+	FSimplePhysicsSweepQuery()
+		:
+		Start(FVector::ZeroVector),
+		End(FVector::ZeroVector),
+		Radius(0.f),
+		CollisionMask(MAX_uint32)
+	{}
+
+	FSimplePhysicsSweepQuery(const FVector& InStart, const FVector& InEnd, float InRadius = 0.f, uint32 InCollisionMask = MAX_uint32)
+		:
+		Start(InStart),
+		End(InEnd),
+		Radius(InRadius),
+		CollisionMask(InCollisionMask)
+	{}
+};
+
+
+/**
+ * Sphere tested for overlapping RigidBodies by USimplePhysicsSolver::OverlapBatch().
+ */
+struct FSimplePhysicsOverlapQuery
+{
+	FVector Center;
+	float Radius;
+
+	/** Only RigidBodies with a collision category in CollisionMask are found */
+	uint32 CollisionMask;
+
+	FSimplePhysicsOverlapQuery()
+		:
+		Center(FVector::ZeroVector),
+		Radius(0.f),
+		CollisionMask(MAX_uint32)
+	{}
+
+	FSimplePhysicsOverlapQuery(const FVector& InCenter, float InRadius, uint32 InCollisionMask = MAX_uint32)
+		:
+		Center(InCenter),
+		Radius(InRadius),
+		CollisionMask(InCollisionMask)
+	{}
+};
+
+
+/**
+ * First RigidBody hit by a sweep query. Body is invalid if nothing was hit.
+ */
+struct FSimplePhysicsQueryHit
+{
+	FSimplePhysicsBodyHandle Body;
+
+	/** Fraction of the sweep before the query touches Body. 0 if the query starts overlapping Body */
+	float Time;
+
+	/** Location of the query sphere when it touches Body */
+	FVector Location;
+
+	/** Point on the surface of Body */
+	FVector ImpactPoint;
+
+	/** Surface normal of Body at ImpactPoint */
+	FVector Normal;
+
+	FSimplePhysicsQueryHit()
+		:
+		Time(1.f),
+		Location(FVector::ZeroVector),
+		ImpactPoint(FVector::ZeroVector),
+		Normal(FVector::ZeroVector)
+	{}
+
+	bool IsValidHit() const { return Body.IsValid(); }
+};
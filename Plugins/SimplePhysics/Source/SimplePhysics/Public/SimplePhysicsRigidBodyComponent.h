@@ -5,8 +5,10 @@
 #include "CoreMinimal.h"
 #include "GameFramework/MovementComponent.h"
 #include "SimplePhysics.h"
+#include "SimplePhysicsBodyStore.h"
 #include "SimplePhysicsRigidBodyComponent.generated.h"
 
+class USimplePhysicsBodyProfile;
 class USimplePhysicsSolver;
 class USphereComponent;
 
@@ -23,17 +25,39 @@ class SIMPLEPHYSICS_API USimplePhysicsRigidBodyComponent : public UMovementCompo
 
 	DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnRigidBodyBounceDelegate, const FHitResult&, ImpactResult, const FVector&, ImpactVelocity, const FVector&, ResultVelocity);
 	DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnSimulationStopDelegate);
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnRigidBodyEscapedDelegate);
+	DECLARE_MULTICAST_DELEGATE_ThreeParams(FOnRigidBodyBounceNativeDelegate, const FHitResult&, const FVector&, const FVector&);
 
 public:
 
-	/** Event when this RigidBody collides with another blocking surface */
+	/**
+	 * Event when this RigidBody collides with another blocking surface. Sent once per frame after the solver has moved all RigidBodies,
+	 * with the first hit of the frame, the velocity before it and the velocity after the last bounce of the frame.
+	 */
 	UPROPERTY(BlueprintAssignable)
 	FOnRigidBodyBounceDelegate OnRigidBodyBounceDelegate;
 
-	/** Called when simulation is stopped for this RigidBody. Will not be called when calling SetSimulationEnabled to stop simulation */
+	/** Same as OnRigidBodyBounceDelegate for native code, without the cost of a dynamic delegate */
+	FOnRigidBodyBounceNativeDelegate OnRigidBodyBounceNativeDelegate;
+
+	/** Called when this RigidBody comes to rest and goes to sleep. Will not be called when calling SetSimulationEnabled to stop simulation */
 	UPROPERTY(BlueprintAssignable)
 	FOnSimulationStopDelegate OnSimulationStopDelegate;
 
+	/**
+	 * Called when this RigidBody leaves the simulation bounds of the solver, such as the room it plays in. Simulation is already stopped,
+	 * so game code can recycle the RigidBody. See bDetectEscapedBodies in SimplePhysics_Settings.
+	 */
+	UPROPERTY(BlueprintAssignable)
+	FOnRigidBodyEscapedDelegate OnEscapedDelegate;
+
+	/**
+	 * Tuning values shared with other RigidBodies of the same archetype. When set, the tuning properties below are ignored,
+	 * except Mass and MomentOfInertia. Call RefreshBodyParams after changing while simulating.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TObjectPtr<USimplePhysicsBodyProfile> BodyProfile;
+
 	/** Should this RigidBody simulate acceleration due to gravity */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	bool bUseGravity;
@@ -108,6 +132,14 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	float TempScale;
 
+	/** Collision categories this RigidBody belongs to. Call RefreshBodyParams after changing while simulating */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Collision", meta = (Bitmask))
+	int32 CollisionCategoryBits;
+
+	/** Collision categories of other RigidBodies this RigidBody collides with. Both RigidBodies of a pair have to accept each other */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Collision", meta = (Bitmask))
+	int32 CollisionMaskBits;
+
 	/** Get a pointer to the SimplePhysicsSolver Subsystem */
 	USimplePhysicsSolver* GetSimplePhysicsSolver() const;
 
@@ -116,36 +148,18 @@ public:
 	void SetSimulationEnabled(bool Enabled);
 
 	//Begin UMovementComponent Interface
-	virtual float GetMaxSpeed() const override { return MaxSpeed; }
+	virtual float GetMaxSpeed() const override;
 	virtual void InitializeComponent() override;
+	virtual void UninitializeComponent() override;
 	//End UMovementComponent Interface
 
-	float GetMaxAngularVelocity() const { return MaxAngularVelocity; }
+	float GetMaxAngularVelocity() const;
 
+	/** Add a Force that is applied every movement update */
 	virtual void AddForce(const FVector& Force);
-	bool HasPendingForce() const { return PendingForce.SquaredLength() > 0.f; }
-	FVector GetPendingForce() const { return PendingForce; }
-	void ClearPendingForce() { PendingForce = FVector::ZeroVector; }
 
+	/** Add a Torque that is applied every movement update */
 	virtual void AddTorque(const FVector& Torque);
-	bool HasPendingTorque() const { return PendingTorque.SquaredLength() > 0.f; }
-	FVector GetPendingTorque() const { return PendingTorque; }
-	void ClearPendingTorque() { PendingTorque = FVector::ZeroVector; }
-
-
-	FVector ComputeAngularVelocityDelta(const FVector& InAngularVelocity, float DeltaTime) const;
-
-	FVector ComputeAngularVelocity(const FVector& InitialAngularVelocity, float DeltaTime) const;
-
-	FVector ComputeAngularAcceleration(const FVector& InitialAngularVelocity, float DeltaTime) const;
-
-	virtual FVector GetAngularDragTorque(const FVector& InAngularVelocity) const;
-
-	/** Get the linear drag force acting on the RigidBody given a velocity */
-	virtual FVector GetLinearDragForce(const FVector& InVelocity) const;
-
-	/** Compute the distance we should move the RigidBody given time, at a given a velocity. */
-	FVector ComputeMoveDelta(const FVector& InVelocity, float DeltaTime) const;
 
 	/** Set the velocity of the UpdatedComponent. Be default will call UpdateComponentVelocity in base class */
 	void SetVelocity(const FVector& NewVelocity, bool UpdateVelocity = true);
@@ -157,46 +171,17 @@ public:
 	/** Calculate the RestitutionCoefficient to apply to collision calculations when two RigidBodies collide */
 	float GetRestitutionCoefficient(TObjectPtr<USimplePhysicsRigidBodyComponent> OtherRidigBody) const;
 
-	//FRotator ComputeRotationDelta
-
-	/**
-	 * Given an initial velocity and a time step, compute a new velocity
-	 * Default implementation applies the result of ComputeAcceleration() to velocity.
-	 *
-	 * @param  InitialVelocity Initial velocity.
-	 * @param  DeltaTime Time step of the update.
-	 * @return Velocity after DeltaTime time step.
-	 */
-	FVector ComputeVelocity(const FVector& InitialVelocity, float DeltaTime) const;
-
 	/** Limit NewVelocity to have a length no grater than MaxSpeed */
 	FVector LimitVelocity(FVector NewVelocity) const;
-	/** Limit Velocity to have a length no greater than MaxSpeed */
-	FVector LimitVelocityFromCurrent();
 
 	FVector LimitAngularVelocity(FVector NewAngularVelocity) const;
 
-	/** Compute the acceleration that will be applied */
-	FVector ComputeAcceleration(const FVector& InitialVelocity, float DeltaTime) const;
-
-
-	/** Call after moving the updated component. Will change Velocity based on PendingForces, Gravity and LinearDamping  */
-	void UpdateMovementVelocity(const FVector& OldVelocity, float DeltaTime);
-
 	/**
-	 * Call after moving the updated component. Will change Velocity based on PendingForces, Gravity and LinearDamping.
-	 * If Hit is a blocking hit DeltaTime will be modified using Hit.Time.
+	 * Stop colliding with other RigidBodies in the same ignore group for Duration seconds of simulation.
+	 * Use USimplePhysicsSolver::NewIgnoreGroup() to get a group for bodies spawned together, such as fragments of the same parent.
 	 */
-	void UpdateMovementVelocity(const FVector& OldVelocity, const FHitResult& Hit, float DeltaTime);
-
-	/** Call after moving the updated component. Will change AngularVelocity based on PendingForces and AngularDamping.  */
-	void UpdateMovementAngularVelocity(const FVector& OldAngularVelocity, float DeltaTime);
-
-	/**
-     * Call after moving the updated component. Will change AngularVelocity based on PendingForces and AngularDamping.
-     * If Hit is a blocking hit DeltaTime will be modified using Hit.Time.
-     */
-	void UpdateMovementAngularVelocity(const FVector& OldAngularVelocity, const FHitResult& Hit, float DeltaTime);
+	UFUNCTION(BlueprintCallable)
+	void SetIgnoreGroup(int32 GroupId, float Duration);
 
 	/** Stop all movement by setting Velocity magnitide to 0 */
 	void StopAllMovementImmediately();
@@ -207,17 +192,14 @@ public:
 	/** Get acceleration from gravity in cm/s^2 (Will apply GravityScale) */
 	float GetGravityZ() const override;
 
-	void SetLastBlockingHitResult(const FHitResult& Hit);
 	void ClearLastBlockingHitResult();
 
-	//EHandleBlockingHitResult HandleBlockingHit(const FHitResult& Hit, float TimeTick, const FVector& MoveDelta, float& SubTickTimeRemaining);
-	//void HandleImpact(const FHitResult& Hit, float TimeSlice, const FVector& MoveDelta);
-
 	USimplePhysicsRigidBodyComponent();
 
-	const FHitResult& GetLastHitResult() const { return LastHitResult; }
+	/** Last blocking hit of this RigidBody. A hit with no blocking hit if there was none, or the solver does not keep them, see SimplePhysics_Settings */
+	const FHitResult& GetLastHitResult() const;
 
-	const USphereComponent* GetSphereComponent() const { return OwnerSphereComponent; }
+	const USphereComponent* GetSphereComponent() const;
 
 	float GetScaledSphereRadius() const;
 
@@ -226,7 +208,7 @@ public:
 	void SetMass(float NewMass);
 	float GetMass() const { return Mass; }
 
-	void SetMomentOfInertia(float NewMomentOfInertia) { MomentOfInertia = NewMomentOfInertia; }
+	void SetMomentOfInertia(float NewMomentOfInertia);
 	float GetMomentOfInertia() const;
 
 	void ApplyRotationDelta(const FRotator& RotationDelta);
@@ -234,29 +216,27 @@ public:
 	void AddAngularVelocity(const FVector& AngularVelocityToAdd);
 	void AddVelocity(const FVector& VelocityToAdd);
 
-protected:
-
-	/*UPROPERTY(VisibleAnywhere, BlueprintReadWrite)
-	bool bSimulationEnabled;*/
-
-	/** Accumulated Force to apply next movement update */
-	FVector PendingForce;
-
-	/** Accumulated Torque to apply next movement update */
-	FVector PendingTorque;
+	/** Get the tuning values used by the solver for this RigidBody */
+	FSimplePhysicsBodyParams GetBodyParams() const;
 
-	FHitResult LastHitResult;
+	/** Collision categories and mask from BodyProfile, or from this RigidBody without a profile */
+	uint32 GetCollisionCategoryBits() const;
+	uint32 GetCollisionMaskBits() const;
 
+	/**
+	 * Copy tuning values, mass and moment of inertia to the solver. Called when simulation is enabled.
+	 * Call after changing tuning values of a RigidBody that is already simulating.
+	 */
+	UFUNCTION(BlueprintCallable)
+	void RefreshBodyParams();
 
-	/** Values loaded from SimplePhysics_Settings */
-	float GravityAcceleration;
-
-	USphereComponent* OwnerSphereComponent;
+	/** Handle of this RigidBody in the solver body store. Invalid if not added to the solver */
+	const FSimplePhysicsBodyHandle& GetBodyHandle() const { return BodyHandle; }
 
 private:
 
-	float CalculatedMomentOfInertia;
-
+	friend struct FSimplePhysicsBodyStore;
 
-	
+	/** Set by FSimplePhysicsBodyStore */
+	FSimplePhysicsBodyHandle BodyHandle;
 };
@@ -4,13 +4,307 @@
 
 #include "CoreMinimal.h"
 #include "SimplePhysics.h"
+#include "SimplePhysicsBodyStore.h"
+#include "SimplePhysicsBroadphase.h"
+#include "SimplePhysicsInputRecording.h"
+#include "SimplePhysicsQuery.h"
+#include "SimplePhysicsStats.h"
+#include "SimplePhysicsStaticColliders.h"
+#include "Engine/EngineTypes.h"
 #include "Subsystems/WorldSubsystem.h"
+#include "Tasks/Task.h"
 #include "SimplePhysicsSolver.generated.h"
 
 class USimplePhysicsRigidBodyComponent;
 
+
+/**
+ * Collision settings of a primitive before the solver changed them, so they can be restored when the solver lets go of it.
+ */
+struct FSimplePhysicsSavedCollision
+{
+	TWeakObjectPtr<UPrimitiveComponent> Primitive;
+	TEnumAsByte<ECollisionChannel> ObjectType;
+
+	/** Response of Primitive to the RigidBody object type */
+	TEnumAsByte<ECollisionResponse> Response;
+
+	FSimplePhysicsSavedCollision()
+		:
+		ObjectType(ECollisionChannel::ECC_WorldStatic),
+		Response(ECollisionResponse::ECR_Block)
+	{}
+};
+
+
+/**
+ * Time spent in each phase of the solver since the stats were last reset.
+ */
+struct FSimplePhysicsSolverStats
+{
+	int32 NumSteps;
+	int32 NumSubsteps;
+	int32 NumContacts;
+	int32 NumAdded;
+	int32 NumRemoved;
+
+	/** Move iterations of all bodies, and moves aborted because the body became invalid or started penetrating */
+	int32 NumIterations;
+	int32 NumAborts;
+
+	/** Moves done without an engine sweep because the body had no contact candidates, including moves up to a static collider */
+	int32 NumTeleports;
+
+	/** Simulating bodies left waiting for their next update because of a reduced update rate */
+	int32 NumSkippedMoves;
+
+	/** Broadphase pairs dropped by collision categories or ignore groups before contact generation */
+	int32 NumRejectedPairs;
+
+	/** Passes of the contact solver, which stops early once impulses converge, and contacts started from the previous impulse */
+	int32 NumContactSolverPasses;
+	int32 NumWarmStartedContacts;
+
+	/** Moves along a cached resting contact instead of bouncing off the surface */
+	int32 NumRestingMoves;
+
+	/** Stuck bodies pushed out at the end of a step, and bodies that stopped simulating after leaving the simulation bounds */
+	int32 NumDepenetrations;
+	int32 NumEscapedBodies;
+
+	/** Scene queries run through RayCast(), SphereSweep(), Overlap() and the batched queries */
+	int32 NumQueries;
+
+	double GatherSeconds;
+	double IntegrateSeconds;
+	double BroadphaseSeconds;
+	double SolveContactsSeconds;
+	double MoveSeconds;
+	double WritebackSeconds;
+
+	/** Time spent preparing steps on a worker task with async stepping. Not part of GetTotalSeconds(), as it does not block the game thread */
+	double AsyncStageSeconds;
+
+	/** Steps that used the step prepared by the async task, and steps that had to drop it */
+	int32 NumAsyncStagesUsed;
+	int32 NumAsyncStagesDropped;
+
+	FSimplePhysicsSolverStats()
+		:
+		NumSteps(0),
+		NumSubsteps(0),
+		NumContacts(0),
+		NumAdded(0),
+		NumRemoved(0),
+		NumIterations(0),
+		NumAborts(0),
+		NumTeleports(0),
+		NumSkippedMoves(0),
+		NumRejectedPairs(0),
+		NumContactSolverPasses(0),
+		NumWarmStartedContacts(0),
+		NumRestingMoves(0),
+		NumDepenetrations(0),
+		NumEscapedBodies(0),
+		NumQueries(0),
+		GatherSeconds(0.0),
+		IntegrateSeconds(0.0),
+		BroadphaseSeconds(0.0),
+		SolveContactsSeconds(0.0),
+		MoveSeconds(0.0),
+		WritebackSeconds(0.0),
+		AsyncStageSeconds(0.0),
+		NumAsyncStagesUsed(0),
+		NumAsyncStagesDropped(0)
+	{}
+
+	double GetTotalSeconds() const { return GatherSeconds + IntegrateSeconds + BroadphaseSeconds + SolveContactsSeconds + MoveSeconds + WritebackSeconds; }
+};
+
+
+/**
+ * Memory used by the RigidBodies known to the solver. Logged by the SimplePhysics.Footprint console command.
+ */
+struct FSimplePhysicsMemoryFootprint
+{
+	int32 NumBodies;
+
+	/** Size of a single USimplePhysicsRigidBodyComponent, including the UMovementComponent base */
+	SIZE_T ComponentBytes;
+
+	/** Bytes allocated by the body store, including slack */
+	SIZE_T BodyStoreBytes;
+
+	/** Bytes allocated by tables only holding entries for some bodies, such as last hit results and cached contacts */
+	SIZE_T SideTableBytes;
+
+	FSimplePhysicsMemoryFootprint()
+		:
+		NumBodies(0),
+		ComponentBytes(0),
+		BodyStoreBytes(0),
+		SideTableBytes(0)
+	{}
+
+	/** Bytes used per RigidBody, averaged over all bodies */
+	SIZE_T GetBytesPerBody() const { return ComponentBytes + (NumBodies > 0 ? (BodyStoreBytes + SideTableBytes) / NumBodies : 0); }
+};
+
+
+/**
+ * Solver values lowered by the frame budget to reduce the cost of the solver.
+ */
+struct FSimplePhysicsQuality
+{
+	int32 MaxSimulationIterations;
+	int32 ContactSolverIterations;
+	int32 MaxSubsteps;
+	float MinimumSimulationVelocity;
+
+	FSimplePhysicsQuality()
+		:
+		MaxSimulationIterations(3),
+		ContactSolverIterations(4),
+		MaxSubsteps(4),
+		MinimumSimulationVelocity(0.01f)
+	{}
+
+	/** Values Alpha of the way from this quality to Lowest */
+	FSimplePhysicsQuality Lerp(const FSimplePhysicsQuality& Lowest, float Alpha) const;
+};
+
+
 /**
- * 
+ * Contact between two RigidBodies kept from the previous step to warm start the contact solver.
+ * Keyed by both body handles ordered by slot, with Normal pointing from the second body to the first.
+ */
+struct FSimplePhysicsCachedContact
+{
+	FVector Normal;
+	float NormalImpulse;
+
+	FSimplePhysicsCachedContact()
+		:
+		Normal(FVector::ZeroVector),
+		NormalImpulse(0.f)
+	{}
+
+	FSimplePhysicsCachedContact(const FVector& InNormal, float InNormalImpulse)
+		:
+		Normal(InNormal),
+		NormalImpulse(InNormalImpulse)
+	{}
+};
+
+
+/**
+ * Surface a RigidBody came to rest against. While the contact is kept, moves of the body have their approach
+ * towards the surface removed before sweeping, so the body slides along it instead of bouncing off it every step.
+ */
+struct FSimplePhysicsRestingContact
+{
+	/** Object hit, null for static colliders without a source actor */
+	TWeakObjectPtr<const UObject> Object;
+	bool bHasObject;
+
+	/** Surface normal facing the body */
+	FVector Normal;
+
+	/** Last step a sweep hit the surface */
+	int64 ConfirmedStep;
+
+	FSimplePhysicsRestingContact()
+		:
+		bHasObject(false),
+		Normal(FVector::ZeroVector),
+		ConfirmedStep(0)
+	{}
+};
+
+
+/**
+ * Bounce of a RigidBody queued by the solver and sent to its component once all bodies have moved.
+ */
+struct FSimplePhysicsBounceEvent
+{
+	/** Body that bounced. Bodies can be compacted by later steps of the frame, so the event does not hold its index */
+	FSimplePhysicsBodyHandle Body;
+
+	FHitResult Hit;
+	FVector ImpactVelocity;
+	FVector ResultVelocity;
+};
+
+
+/**
+ * Input to the solver made by game code while the async stage was running. Applied at the start of the next frame.
+ */
+struct FSimplePhysicsDeferredInput
+{
+	ESimplePhysicsInputType Type;
+	TWeakObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody;
+	FVector Value;
+	float Scalar;
+
+	FSimplePhysicsDeferredInput(ESimplePhysicsInputType InType, USimplePhysicsRigidBodyComponent* InRigidBody, const FVector& InValue, float InScalar)
+		:
+		Type(InType),
+		RigidBody(InRigidBody),
+		Value(InValue),
+		Scalar(InScalar)
+	{}
+};
+
+
+/**
+ * Integration, broadphase and contacts of a step, indexed by body index. The async stage prepares the next step into its own output,
+ * which only replaces the one of the solver once the step uses it.
+ */
+struct FSimplePhysicsStageOutput
+{
+	/** Time each body moves by this substep. 0 for bodies waiting for their next update */
+	TArray<float> BodyStepTimes;
+
+	/** Body indices simulating this substep */
+	TArray<int32> SimulatingBodies;
+
+	/** Free flight movement of each body over this substep. Zero movement for bodies not simulating */
+	TArray<FSimplePhysicsIntegrationResult> IntegrationResults;
+
+	/** Body indices inserted in Broadphase this substep */
+	TArray<int32> BroadphaseBodies;
+
+	/** Spatial hash over BroadphaseBodies */
+	FSimplePhysicsSpatialHash Broadphase;
+
+	/** Scratch array for the sleeping bodies found near a body */
+	TArray<int32> SleepingQueryResults;
+
+	/** Body index pairs with overlapping bounds this substep */
+	TArray<FSimplePhysicsCandidatePair> CandidatePairs;
+
+	/** Pairs dropped by collision filters. Added to Stats on the game thread */
+	int32 NumRejectedPairs;
+
+	/** CandidatePairs with a simulating body, from the point of view of that body. Tested for contacts in batches */
+	TArray<int32> ContactTestBodies;
+	TArray<int32> ContactTestOtherBodies;
+
+	/** Is the body in any of CandidatePairs */
+	TArray<bool> HasCandidatePairs;
+
+	/** Contacts found in CandidatePairs, ordered by time of impact */
+	TArray<FSimplePhysicsContact> Contacts;
+
+	FSimplePhysicsStageOutput()
+		:
+		NumRejectedPairs(0)
+	{}
+};
+
+
+/**
+ *
  */
 UCLASS()
 class SIMPLEPHYSICS_API USimplePhysicsSolver : public UTickableWorldSubsystem
@@ -24,6 +318,27 @@ public:
 	/** Called once all UWorldSubsystems have been initialized */
 	virtual void PostInitialize() override;
 
+	virtual void Deinitialize() override;
+
+	/**
+	 * Record every input to the solver and the DeltaTime of each frame until StopInputRecording() is called.
+	 * Also started by the -SimplePhysicsRecord=<File> command line argument, and stopped when the world is destroyed.
+	 */
+	void StartInputRecording(const FString& Filename);
+
+	/** Stop recording and save the recording. Returns false if nothing was recorded or the file could not be written */
+	bool StopInputRecording();
+
+	/**
+	 * Drive the solver from a recording instead of game code. Inputs from game code are ignored and each frame steps by the recorded DeltaTime.
+	 * Also started by the -SimplePhysicsReplay=<File> command line argument, so a recorded session can be replayed headless with -nullrhi.
+	 * Add -SimplePhysicsReplayExit to quit once the replay is done.
+	 */
+	bool StartInputReplay(const FString& Filename);
+
+	bool IsRecordingInput() const { return InputMode == EInputMode::Record; }
+	bool IsReplayingInput() const { return InputMode == EInputMode::Replay; }
+
 	/* Enable/Disable simulation for an actor with attached USimplePhysicsRigidBodyComponent */
 	void SetSimulationEnabled(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody, bool Enabled);
 
@@ -31,71 +346,564 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void SetSimulationEnabled(AActor* Actor, bool Enabled);
 
+	/** Is simulation enabled for RigidBody. True for sleeping RigidBodies */
 	UFUNCTION(BlueprintCallable)
 	bool IsSimulating(const USimplePhysicsRigidBodyComponent* RigidBody) const;
 
+	/** Is RigidBody at rest. Sleeping RigidBodies cost nothing until woken by a contact or being moved */
+	UFUNCTION(BlueprintCallable)
+	bool IsSleeping(const USimplePhysicsRigidBodyComponent* RigidBody) const;
+
+	/** Wake a sleeping RigidBody and all sleeping RigidBodies touching it */
+	void WakeRigidBody(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody);
+
+	/**
+	 * Add a RigidBody to the body store. RigidBodies with a USphereComponent as the UpdatedComponent are also added to
+	 * the broadphase, so other RigidBodies collide with them even when they are not simulating.
+	 */
+	void AddRigidBody(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody);
+
+	/** Remove a RigidBody from the body store. Waits for the async stage if it is running */
+	void RemoveRigidBody(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody);
+
+	/** Copy tuning values, mass and moment of inertia of a RigidBody to the body store */
+	void RefreshRigidBody(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody);
+
+	/** Add a Force applied to RigidBody every movement update */
+	void AddForce(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody, const FVector& Force);
+
+	/** Add a Torque applied to RigidBody every movement update */
+	void AddTorque(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody, const FVector& Torque);
+
+	void SetVelocity(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody, const FVector& NewVelocity);
+	void SetAngularVelocity(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody, const FVector& NewAngularVelocity);
+
+	/** Add an Impulse to the velocity of RigidBody, waking it if it is sleeping. With bVelocityChange the mass of RigidBody is ignored */
+	void AddImpulse(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody, const FVector& Impulse, bool bVelocityChange = false);
+
+	/**
+	 * Push every simulating or sleeping RigidBody within Radius of Origin away from it, waking sleeping ones.
+	 * Bodies are gathered from the scene query index, so the cost depends on the bodies near Origin rather than all bodies.
+	 * Distance is measured to the surface of each body. RIF_Linear fades Strength to 0 at Radius.
+	 * @return number of RigidBodies pushed
+	 */
+	int32 ApplyRadialImpulse(const FVector& Origin, float Radius, float Strength, ERadialImpulseFalloff Falloff = RIF_Constant, bool bVelocityChange = false, uint32 CollisionMask = MAX_uint32);
+
+	/** Get an ignore group id not used by any other RigidBody */
+	int32 NewIgnoreGroup() { return ++LastIgnoreGroup; }
+
+	/** Stop RigidBody colliding with other RigidBodies in GroupId for Duration seconds of simulation. GroupId 0 clears the group */
+	void SetIgnoreGroup(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody, int32 GroupId, float Duration);
+
+	/**
+	 * Replace the static geometry RigidBodies bounce off analytically. Primitives of ColliderActors stop blocking RigidBodies,
+	 * so the same geometry is not also hit by engine sweeps. Primitives of the previous ColliderActors block RigidBodies again.
+	 */
+	void SetStaticColliders(const FSimplePhysicsStaticColliderSet& InStaticColliders, const TArray<AActor*>& ColliderActors);
+
+	/** Remove all static colliders and the simulation bounds. RigidBodies only collide with the world through engine sweeps */
+	void ClearStaticColliders();
+
+	const FSimplePhysicsStaticColliderSet& GetStaticColliders() const { return StaticColliders; }
+
+	/**
+	 * Set the volume RigidBodies have to stay inside, such as the room they play in. With bDetectEscapedBodies set in SimplePhysics_Settings,
+	 * RigidBodies leaving it stop simulating and send OnEscapedDelegate. Also set to the bounds of the colliders by SetStaticColliders().
+	 */
+	void SetSimulationBounds(const FBox& Bounds);
+
+	/** Volume RigidBodies have to stay inside. Invalid if there is none */
+	const FBox& GetSimulationBounds() const { return SimulationBounds; }
+
+	/** Last blocking hit of RigidBody. Only kept when bKeepLastHitResults is set in SimplePhysics_Settings */
+	const FHitResult* FindLastHitResult(const USimplePhysicsRigidBodyComponent* RigidBody) const;
+	void ClearLastHitResult(const USimplePhysicsRigidBodyComponent* RigidBody);
+
+	/** Get the RigidBody of a body handle. nullptr if the body was removed */
+	USimplePhysicsRigidBodyComponent* GetRigidBody(const FSimplePhysicsBodyHandle& Handle) const;
+
+	/**
+	 * Find the first RigidBody a ray from Start to End hits, using the solver's own spatial index instead of the engine collision scene.
+	 * Only RigidBodies with a collision category in CollisionMask are hit.
+	 */
+	bool RayCast(const FVector& Start, const FVector& End, FSimplePhysicsQueryHit& OutHit, uint32 CollisionMask = MAX_uint32);
+
+	/** Find the first RigidBody a sphere of Radius moving from Start to End hits */
+	bool SphereSweep(const FVector& Start, const FVector& End, float Radius, FSimplePhysicsQueryHit& OutHit, uint32 CollisionMask = MAX_uint32);
+
+	/** Append every RigidBody overlapping a sphere of Radius at Center to OutBodies. Returns the number of bodies found */
+	int32 Overlap(const FVector& Center, float Radius, TArray<FSimplePhysicsBodyHandle>& OutBodies, uint32 CollisionMask = MAX_uint32);
+
+	/**
+	 * Run many sweeps in one pass, for example every projectile fired this frame. Queries are spread over worker threads.
+	 * OutHits has one hit per query, with an invalid Body for queries that hit nothing.
+	 */
+	void SweepBatch(TConstArrayView<FSimplePhysicsSweepQuery> Queries, TArray<FSimplePhysicsQueryHit>& OutHits);
+
+	/**
+	 * Run many overlap queries in one pass. The bodies found by query N are
+	 * OutBodies[OutQueryStarts[N]] up to OutBodies[OutQueryStarts[N + 1]], OutQueryStarts has one extra entry at the end.
+	 */
+	void OverlapBatch(TConstArrayView<FSimplePhysicsOverlapQuery> Queries, TArray<FSimplePhysicsBodyHandle>& OutBodies, TArray<int32>& OutQueryStarts);
+
+	/** Measure the memory used by the RigidBodies known to the solver */
+	FSimplePhysicsMemoryFootprint GetMemoryFootprint() const;
+
+	/** Quality level chosen by the frame budget. 0 is full quality */
+	int32 GetQualityLevel() const { return QualityLevel; }
+
+	/** Time spent in each solver phase since the last call to ResetStats() */
+	const FSimplePhysicsSolverStats& GetStats() const { return Stats; }
+	void ResetStats() { Stats = FSimplePhysicsSolverStats(); }
+
 	/** Begin UTickableWorldSubsystem Interface */
 	virtual bool IsTickable() const override;
 	virtual void Tick(float DeltaTime) override;
-	virtual TStatId GetStatId() const override { RETURN_QUICK_DECLARE_CYCLE_STAT(FSimplePhysicsSolverStat, STATGROUP_Tickables); }
+	virtual TStatId GetStatId() const override { RETURN_QUICK_DECLARE_CYCLE_STAT(FSimplePhysicsSolverStat, STATGROUP_SimplePhysics); }
 	/** End UTickableWorldSubsystem Interface */
 
 protected:
 
-	/** Applies deflection logic from colliding with a non Simple Physics Rigid Body actor. Will trigger RigidBodies OnRigidBodyBounce event. */
-	virtual void HandleImpact(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody, const FHitResult& Hit, float TimeSlice, const FVector& MoveDelta);
+	/** Applies deflection logic from colliding with a non Simple Physics Rigid Body actor. Will queue a RigidBodies OnRigidBodyBounce event. */
+	virtual void HandleImpact(int32 BodyIndex, const FHitResult& Hit, float TimeSlice, const FVector& MoveDelta);
 
-	/** Apply collision logic from two Simple Physics Rigidbodies collide with each other.  */
-	virtual void HandleRigidBodyCollision(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody, TObjectPtr<USimplePhysicsRigidBodyComponent> OtherRigidBody, const FHitResult& Hit);
+	/** Apply collision logic from two Simple Physics Rigidbodies collide with each other. Used for contacts found by engine sweeps, broadphase contacts go through SolveContacts() */
+	virtual void HandleRigidBodyCollision(int32 BodyIndex, int32 OtherBodyIndex, const FHitResult& Hit);
 
 	/** Compute the resulting velocities of two Simple Physics Rigidbodies collide with each other.  */
-	virtual bool ComputeRigidBodyCollision(const FHitResult& Hit, TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody1, TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody2,	FMovementData& RigidBody1MovementData, FMovementData& RigidBody2MovementData) const;
+	virtual bool ComputeRigidBodyCollision(const FHitResult& Hit, int32 BodyIndex1, int32 BodyIndex2, FMovementData& RigidBody1MovementData, FMovementData& RigidBody2MovementData) const;
 
 	/** Computes the result of RigidBody bouncing off a non Simple Physics Rigid Body actor */
-	virtual bool ComputeBounceResult(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody, const FHitResult& Hit, float TimeSlice, const FVector& MoveDelta, FMovementData& ResultMovementData);
+	virtual bool ComputeBounceResult(int32 BodyIndex, const FHitResult& Hit, float TimeSlice, const FVector& MoveDelta, FMovementData& ResultMovementData);
 
 	/** Return true if RigidBody is able to simulate this frame */
 	virtual bool CanSimulateRigidBodyMovement(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody, float DeltaTime) const;
 
 private:
 
-	/** Current RigidBodies being simulated each frame */
-	TArray<TObjectPtr<USimplePhysicsRigidBodyComponent>> SimulatedRigidBodies;
+	/** State of every RigidBody known to the solver, simulating or not */
+	UPROPERTY()
+	FSimplePhysicsBodyStore Bodies;
+
+	/** Bodies with a pending change in Bodies.PendingSimulation, applied at the start of the next frame */
+	TArray<FSimplePhysicsBodyHandle> PendingSimulationChanges;
+
+	/** Integration, broadphase and contacts of the current substep */
+	FSimplePhysicsStageOutput StageOutput;
+
+	/** Collision settings of each RigidBody primitive before it was given RigidBodyObjectType. Restored when the RigidBody is removed */
+	TMap<const USimplePhysicsRigidBodyComponent*, FSimplePhysicsSavedCollision> SavedBodyCollisions;
+
+	/** Static geometry tested analytically when moving bodies */
+	FSimplePhysicsStaticColliderSet StaticColliders;
+
+	/** Primitives of the actors passed to SetStaticColliders() with their response to RigidBodyObjectType before it was ignored */
+	TArray<FSimplePhysicsSavedCollision> StaticColliderPrimitives;
+
+	/** Volume bodies have to stay inside. Invalid if there is none */
+	FBox SimulationBounds;
+
+	/**
+	 * Bodies overlapping geometry after the moves of this step, resolved by DepenetrateStuckBodies(). The value is the engine penetration adjustment
+	 * of bodies that started a move stuck, and zero for overlaps found by FindOverlappingBodies()
+	 */
+	TMap<FSimplePhysicsBodyHandle, FVector> StuckBodies;
+
+	/** Bodies that left SimulationBounds this frame. Their events are sent after all bodies moved */
+	TArray<FSimplePhysicsBodyHandle> EscapedBodies;
+
+	/** Spatial hash over sleeping bodies. Only rebuilt when a body goes to sleep or wakes */
+	FSimplePhysicsSpatialHash SleepingBroadphase;
+	bool bSleepingBroadphaseDirty;
+
+	/** Scratch arrays used when waking bodies */
+	TArray<int32> WakeQueue;
+	TArray<int32> SleepingQueryResults;
+
+	/** Spatial hash over every collidable body at its current location, used by scene queries. Rebuilt on the first query after bodies change */
+	FSimplePhysicsSpatialHash QueryIndex;
+	bool bQueryIndexDirty;
+
+	/** Scratch array used by single scene queries */
+	TArray<int32> QueryResults;
+
+	/** Scratch arrays used by ApplyRadialImpulse() */
+	TArray<FSimplePhysicsBodyHandle> RadialImpulseBodies;
+	TArray<int32> RadialImpulseIndices;
+	TArray<FVector> RadialImpulses;
+
+	/** Bounces this frame, at most one per body. Sent by DispatchBounceEvents() */
+	TArray<FSimplePhysicsBounceEvent> BounceEvents;
+
+	/** Indices into Contacts where both bodies respond, solved together by SolveContacts() */
+	TArray<int32> SolvedContacts;
+
+	/** Impulses of the pairs solved last step */
+	TMap<TPair<FSimplePhysicsBodyHandle, FSimplePhysicsBodyHandle>, FSimplePhysicsCachedContact> ContactCache;
+
+	/** Surface each resting body is resting against */
+	TMap<FSimplePhysicsBodyHandle, FSimplePhysicsRestingContact> RestingContacts;
+
+	/** Last blocking hit of each body, kept out of the components as few bodies are ever asked for it */
+	TMap<FSimplePhysicsBodyHandle, FHitResult> LastHitResults;
 
-	/** RigidBodies to add to SimulatedRigidBodies, will be added at before SimulatedRigidBodies are updated the next frame */
-	TArray<TObjectPtr<USimplePhysicsRigidBodyComponent>> AddRigidBodies;
+	/** Time of impact of the first contact resolved for each body this tick, indexed by body index. 1 for no contact */
+	TArray<float> ContactTimes;
 
-	/** RigidBodies found to be invalid this frame. USimplePhysicsRigidBodyComponents in this arrya will be removed from SimulatedRigidBodies at the end of frame */
-	TArray<TObjectPtr<USimplePhysicsRigidBodyComponent>> InvalidRigidBodies;
+	/** Bodies moved without a sweep this tick. Their transforms are written by WriteTeleportedBodies() */
+	TArray<int32> TeleportedBodies;
+
+	/** Bounds of blocking primitives in the room that are neither RigidBodies nor static colliders, such as the player, this step */
+	TArray<FBox> TeleportObstacles;
 
 	/** Values loaded from SimplePhysics_Settings */
 	int32 MaxSimulationIterations;
 	float MinimumSimulationVelocity;
+	float WakeContactTolerance;
+	int32 ContactSolverIterations;
+	bool bWarmStartContacts;
+	float ContactWarmStartFactor;
+	float RestingContactSpeed;
+	int32 RestingContactLifetimeSteps;
+	bool bDepenetrateStuckBodies;
+	float MaxDepenetrationDistance;
+	bool bDetectEscapedBodies;
+	float EscapedBodyMargin;
+	bool bKeepLastHitResults;
+	float BroadphaseCellSize;
+	TEnumAsByte<ECollisionChannel> RigidBodyObjectType;
+	bool bTeleportContactFreeBodies;
+	bool bParallelIntegration;
+	int32 ParallelIntegrationBatchSize;
+	bool bAsyncStepping;
+	bool bUseFixedTimestep;
+	float FixedTimestep;
+	int32 MaxStepsPerFrame;
+	bool bInterpolateFixedSteps;
+	bool bUseSubstepping;
+	int32 MaxSubsteps;
+	float SubstepMaxTravelFraction;
+	bool bUseSignificance;
+	float SignificanceFullRateDistance;
+	float SignificanceHalfRateDistance;
+	bool bReduceRateOutOfView;
+	bool bUseFrameBudget;
+	float FrameBudgetMilliseconds;
+	int32 FrameBudgetQualityLevels;
+	float FrameBudgetRecoverFraction;
+	int32 FrameBudgetRecoverFrames;
+
+	/** Quality from SimplePhysics_Settings, and the lowest quality the frame budget may go down to */
+	FSimplePhysicsQuality FullQuality;
+	FSimplePhysicsQuality LowestQuality;
+
+	/** Current quality level, from 0 for FullQuality to FrameBudgetQualityLevels - 1 for LowestQuality */
+	int32 QualityLevel;
+
+	/** Smoothed game thread cost of the solver per frame */
+	double SmoothedFrameMilliseconds;
+
+	/** Frames since QualityLevel last changed */
+	int32 FramesAtQualityLevel;
+
+	/** Consecutive frames the cost stayed below FrameBudgetRecoverFraction of the budget */
+	int32 FramesBelowRecoverBudget;
+
+	enum class EInputMode : uint8
+	{
+		None,
+		Record,
+		Replay
+	};
+
+	EInputMode InputMode;
+
+	/** Inputs recorded this session, or being replayed */
+	FSimplePhysicsInputRecording InputRecording;
+	FString InputRecordingFilename;
+
+	/** Next record of InputRecording to replay */
+	int32 ReplayRecordIndex;
+
+	/** Set while replayed inputs are applied, so they are not ignored as game code input */
+	bool bApplyingReplayInput;
+
+	/** Recorded body id of each body while recording */
+	TMap<FSimplePhysicsBodyHandle, int32> RecordedBodyIds;
+
+	/** Body of each recorded body id while replaying */
+	TMap<int32, FSimplePhysicsBodyHandle> ReplayBodies;
+
+	/** Worker task integrating, updating the broadphase and finding contacts for the next step with async stepping */
+	UE::Tasks::FTask AsyncStageTask;
+
+	/** Step time and step the async stage was prepared for */
+	float AsyncStageTime;
+	int64 AsyncStageStep;
+
+	/** Set once the async stage completed, until the next step uses or drops it */
+	bool bAsyncStageReady;
+
+	/** Step prepared by the async stage. Only written by the task, and only read once it completed */
+	FSimplePhysicsStageOutput AsyncStageOutput;
+
+	/** Bumped whenever inputs, game code or pending changes alter body state the async stage reads */
+	uint32 BodyStateGeneration;
+
+	/** BodyStateGeneration the async stage was prepared from. The prepared step is dropped if it changed since */
+	uint32 AsyncStageGeneration;
+
+	/** Time spent by the async stage, written by the task and added to Stats once it completes */
+	double AsyncStageTaskSeconds;
+
+	/** Inputs made while the async stage was running, in order */
+	TArray<FSimplePhysicsDeferredInput> DeferredInputs;
+
+	/** Set while deferred inputs are applied, so they are not deferred again */
+	bool bApplyingDeferredInput;
+
+	FSimplePhysicsSolverStats Stats;
+
+	/** Frame time not yet simulated when using a fixed timestep */
+	float StepAccumulator;
+
+	/** Number of steps simulated so far */
+	int64 StepCount;
+
+	/** Simulated time in seconds. Ignore groups expire against this, so replays drop the same pairs */
+	double SimulationTime;
+
+	/** Last id returned by NewIgnoreGroup() */
+	int32 LastIgnoreGroup;
+
+	/** Location of each body at the start of the last step, indexed by body index */
+	TArray<FVector> PreviousPositions;
+
+	/** Bodies placed at an interpolated location last frame, and the location they were placed at */
+	TArray<int32> InterpolatedBodies;
+	TArray<FVector> InterpolatedLocations;
+
+	/** Advance the simulation by whole steps of FixedTimestep and interpolate the remaining time */
+	void StepFixedTimestep(float DeltaTime);
+
+	/** Publish counters of the frame to the SimplePhysics stat group and Insights channel */
+	void ReportFrameStats(const FSimplePhysicsSolverStats& FrameStartStats) const;
+
+	/** Move QualityLevel towards staying under FrameBudgetMilliseconds given the cost of the last frame */
+	void UpdateQualityLevel(double FrameSeconds);
+
+	/** Set QualityLevel and the solver values it controls */
+	void SetQualityLevel(int32 NewQualityLevel);
+
+	/** Advance the simulation by a single step of StepTime */
+	void StepSimulation(float StepTime);
+
+	/** Advance all bodies together by a single substep of SubstepTime */
+	void StepBodies(float SubstepTime);
+
+	/** Number of substeps needed so no simulating body travels more than SubstepMaxTravelFraction of the smallest radius in a substep */
+	int32 ComputeNumSubsteps(float StepTime) const;
+
+	/** Move interpolated bodies back to their simulated location. Bodies moved by anything else since are left where they are */
+	void RestoreInterpolatedTransforms();
+
+	/** Place simulating bodies between their previous and current simulated location */
+	void InterpolateTransforms(float Alpha);
+
+	/**
+	 * Choose the bodies moving in step StepIndex from their update interval, and the time each of them moves by.
+	 * Only reads the body store, so the async stage can schedule the next step.
+	 */
+	void ScheduleBodies(int64 StepIndex, float SubstepTime, FSimplePhysicsStageOutput& Output) const;
+
+	/**
+	 * Set the update interval of each simulating body from its distance to the player camera and whether it is in view.
+	 * In view is tested against a cone of the horizontal field of view, not the view frustum.
+	 */
+	void UpdateSignificance();
+
+	/** Compute the IntegrationResults of Output for all bodies moving this substep. Bodies are independent so this runs on worker threads */
+	void IntegrateBodies(FSimplePhysicsStageOutput& Output) const;
 
 	void ValidateRigidBodyTick(float DeltaTime);
-	/*bool TickRigidBody(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody, float DeltaTime);*/
-	void ApplyRigidBodyMovement(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody, float DeltaTime);
+	void ApplyRigidBodyMovement(int32 BodyIndex, float DeltaTime);
 
 	/** Return true if RigidBody velocity is below the velocity set in SimplePhysics_Settings */
-	bool IsBelowSimulationVelocity(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody) const;
+	bool IsBelowSimulationVelocity(int32 BodyIndex) const;
+
+	/** Inputs from game code are ignored while replaying */
+	bool ShouldIgnoreInput() const { return InputMode == EInputMode::Replay && !bApplyingReplayInput; }
+
+	/** Inputs can not change the body store while the async stage reads it, they are deferred to the next frame instead */
+	bool ShouldDeferInput() const { return AsyncStageTask.IsValid() && !bApplyingDeferredInput; }
+
+	void DeferInput(ESimplePhysicsInputType Type, USimplePhysicsRigidBodyComponent* RigidBody, const FVector& Value = FVector::ZeroVector, float Scalar = 0.f);
+
+	/** Apply all DeferredInputs through the same functions game code called */
+	void ApplyDeferredInputs();
 
-	/** Stop simulating RigidBody will broadcast */
-	void StopSimulating(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody);
+	/** Start preparing the next step on a worker task, if async stepping can be used for it */
+	void LaunchAsyncStage();
 
-	/** Register all AddRigidBodies by adding them to SimulatedRigidBodies. Ensure all InvalidRigidBodies are removed from SimulatedRigidBodies */
+	/** Wait for the async stage to complete, then apply the inputs deferred while it ran */
+	void CompleteAsyncStage();
+
+	/**
+	 * Use the step prepared by the async stage, if it was prepared for StepTime from the current body state.
+	 * @return true if StageOutput was replaced by the prepared step
+	 */
+	bool ConsumeAsyncStage(float StepTime);
+
+	/** Record an input to a body while recording. The body is given an id on its first input */
+	void RecordInput(ESimplePhysicsInputType Type, int32 BodyIndex, const FVector& Value = FVector::ZeroVector, float Scalar = 0.f);
+
+	/** Apply replayed inputs up to the end of the next recorded frame. Returns the recorded DeltaTime, or DeltaTime once the replay is done */
+	float ReplayInputs(float DeltaTime);
+
+	/** Queue a bounce event for a body, or merge it into the event already queued for the body this frame */
+	void QueueBounceEvent(int32 BodyIndex, const FHitResult& Hit, const FVector& ImpactVelocity, const FVector& ResultVelocity);
+
+	/** Send all queued bounce events to their components. Called once per frame after all steps, so listeners never run inside the solver loop */
+	void DispatchBounceEvents();
+
+	/** Send OnEscapedDelegate of every body in EscapedBodies */
+	void DispatchEscapeEvents();
+
+	/** Stop simulating a body at rest and put it to sleep. Will broadcast OnSimulationStopDelegate */
+	void PutToSleep(int32 BodyIndex);
+
+	/** Set the sleep state of a body. Sleeping bodies are woken when their UpdatedComponent is moved */
+	void SetBodySleeping(int32 BodyIndex, bool bSleeping);
+
+	/** Start simulating a sleeping or disabled body this step */
+	void WakeBody(int32 BodyIndex);
+
+	/** Wake BodyIndex, then every sleeping body connected to it through touching sleeping bodies */
+	void WakeIsland(int32 BodyIndex);
+
+	/** Rebuild SleepingBroadphase if bodies went to sleep or woke since the last build */
+	void UpdateSleepingBroadphase();
+
+	void OnSleepingBodyMoved(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport, USimplePhysicsRigidBodyComponent* RigidBody);
+
+	/** Start or stop simulating a body at the start of the next frame */
+	void RequestSimulationChange(int32 BodyIndex, ESimplePhysicsPendingSimulation Change);
+
+	/** Apply all PendingSimulationChanges. Compacts the body store */
 	void RegisterRigidBodies();
 
-	/** Map of new velocities calcuated this frame of rigid bodies colliding with each other */
-	UPROPERTY()
-	TMap<USimplePhysicsRigidBodyComponent*, FMovementData> RigidCollisionResultMap;
+	/** Read location, radius and collision state of all bodies from their components. Only the collision state of sleeping bodies is read */
+	void GatherBodyState();
+
+	/** Get the body index of RigidBody, adding it to the body store if needed. INDEX_NONE if RigidBody can not be added */
+	int32 FindOrAddBody(TObjectPtr<USimplePhysicsRigidBodyComponent> RigidBody);
+
+	/** Set velocities of a body and copy them to its component */
+	void SetBodyMovementData(int32 BodyIndex, const FMovementData& MovementData);
+
+	/** Copy velocities of all bodies moved this tick to their components */
+	void WriteBodyState();
+
+	/**
+	 * Gather TeleportObstacles with a single engine overlap over the static collider bounds, so bodies can skip their sweep
+	 * without passing through geometry the solver does not simulate
+	 */
+	void UpdateTeleportObstacles(float DeltaTime);
+
+	/** Can the body move by MoveDelta this tick without a sweep. Requires static colliders, no broadphase candidates and no TeleportObstacles in the way */
+	bool CanTeleportBody(int32 BodyIndex, const FVector& MoveDelta) const;
+
+	/** Set the transform of all TeleportedBodies to their simulated location, without a sweep or an overlap update */
+	void WriteTeleportedBodies();
+
+	/** Rebuild the spatial hash of Output from Bodies, then gather its CandidatePairs. SleepingBroadphase has to be current */
+	void UpdateBroadphase(FSimplePhysicsStageOutput& Output) const;
+
+	/** Add an impulse to the velocity of a body and wake it. Used by AddImpulse() and ApplyRadialImpulse() once input is not deferred */
+	void ApplyBodyImpulse(int32 BodyIndex, const FVector& Impulse, bool bVelocityChange);
+
+	/** Rebuild QueryIndex if bodies were added, removed or moved since the last scene query */
+	void UpdateQueryIndex();
+
+	/** Find the first body hit by Query in QueryIndex. Candidates is scratch space, so parallel queries do not share it */
+	bool RunSweepQuery(const FSimplePhysicsSweepQuery& Query, TArray<int32>& Candidates, FSimplePhysicsQueryHit& OutHit) const;
+
+	/** Append the bodies overlapping Query in QueryIndex to OutBodies */
+	void RunOverlapQuery(const FSimplePhysicsOverlapQuery& Query, TArray<int32>& Candidates, TArray<FSimplePhysicsBodyHandle>& OutBodies) const;
+
+	/** Find RigidBody vs RigidBody contacts in the CandidatePairs of Output and write them to its Contacts in time of impact order */
+	void GenerateContacts(FSimplePhysicsStageOutput& Output) const;
+
+	/**
+	 * Resolve all Contacts before any RigidBody moves. Contacts between responding bodies are solved together with
+	 * ContactSolverIterations passes of sequential impulses, so clusters of touching bodies share the impulse.
+	 * Each body moves to its earliest contact with its old velocity, then continues with the solved velocity.
+	 */
+	void SolveContacts();
+
+	/** Build the hit result reported for a contact from the point of view of Contact.BodyIndex */
+	FHitResult MakeContactHit(const FSimplePhysicsContact& Contact) const;
+
+	/** Key of the pair of a contact in ContactCache, and whether Contact.Normal is flipped relative to the cached normal */
+	TPair<FSimplePhysicsBodyHandle, FSimplePhysicsBodyHandle> MakeContactCacheKey(const FSimplePhysicsContact& Contact, bool& bOutFlipped) const;
+
+	/**
+	 * Find a resting contact of the body that still holds for a move by MoveDelta over DeltaTime.
+	 * Contacts the body moves away from, or approaches too fast to rest on, are not used.
+	 */
+	bool FindRestingContact(int32 BodyIndex, const FVector& MoveDelta, float DeltaTime, FVector& OutNormal);
+
+	/** Remove the velocity of a body into a resting contact, and the tangential velocity friction takes away with it */
+	void ApplyRestingContact(int32 BodyIndex, const FVector& Normal);
+
+	/** Keep or drop the resting contact of a body after it hit a surface with ImpactVelocity */
+	void UpdateRestingContact(int32 BodyIndex, const FHitResult& Hit, const FVector& ImpactVelocity);
+
+	/**
+	 * Compute the first time the spheres of up to four body pairs touch when moving by their IntegrationResults.
+	 * Only reports contacts where the spheres are approaching each other.
+	 * @param	OutTimes	Fraction of the movement [0,1] at first contact of each pair
+	 * @return bit mask of the pairs that touch during the movement
+	 */
+	int32 ComputeSphereTimeOfImpactBatch(const FSimplePhysicsStageOutput& Output, const int32* BodyIndices, const int32* OtherBodyIndices, int32 NumPairs, float* OutTimes) const;
+
+	/** Let the primitives of the current collider actors block RigidBodies again */
+	void RestoreStaticColliderPrimitives();
+
+	/** Find the first static collider a body touches moving by MoveDelta from its current location */
+	bool FindStaticHit(int32 BodyIndex, const FVector& MoveDelta, FHitResult& OutHit) const;
+
+	/** Add bodies overlapping a static collider or a body of CandidatePairs to StuckBodies. Engine sweeps only report bodies they start inside */
+	void FindOverlappingBodies();
+
+	/** Push every body in StuckBodies out of the static colliders, other bodies and the engine geometry it started a move inside */
+	void DepenetrateStuckBodies();
+
+	/** Stop simulating bodies outside SimulationBounds and queue their escape events */
+	void FindEscapedBodies();
 
 	/** Check if the Rigid body should abort its simulation this tick. */
-	bool ShouldAbort(USimplePhysicsRigidBodyComponent* RigidBody, const FHitResult& Hit) const;
+	bool ShouldAbort(int32 BodyIndex, const FHitResult& Hit) const;
 
-	/** Get the USimplePhysicsRigidBodyComponent if it exists from a FHitResult. Will return nullptr if hit actor does not have a USimplePhysicsRigidBodyComponent */
-	TObjectPtr<USimplePhysicsRigidBodyComponent> GetOtherHitRigidBody(const FHitResult& Hit) const;
+	/** Get the body index of the USimplePhysicsRigidBodyComponent from a FHitResult. Will return INDEX_NONE if hit actor does not have a USimplePhysicsRigidBodyComponent */
+	int32 GetOtherHitBodyIndex(const FHitResult& Hit) const;
 
 protected:
 	/** Minimum delta time considered when ticking. Delta times below this are not considered. This is a very small non-zero positive value to avoid potential divide-by-zero in simulation code. */
 	static const float MIN_TICK_TIME;
+
+	/** Frames the cost has to stay over budget before the quality is lowered again */
+	static const int32 QUALITY_LOWER_FRAMES;
+
+	/** Weight of the latest frame in SmoothedFrameMilliseconds */
+	static const float QUALITY_COST_SMOOTHING;
+
+	/** The contact solver stops once no pass changes a relative normal velocity by more than this in cm/s */
+	static const float CONTACT_CONVERGED_VELOCITY;
+
+	/** Cached contacts are only reused while the contact normal stays within this cosine of the cached normal */
+	static const float CONTACT_CACHE_MIN_NORMAL_DOT;
+
+	/** Batched queries below this count run on the calling thread */
+	static const int32 MIN_PARALLEL_QUERIES;
 };
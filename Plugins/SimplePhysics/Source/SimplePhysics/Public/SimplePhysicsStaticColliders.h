@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/HitResult.h"
+
+class AActor;
+
+
+/**
+ * Finite one sided plane. Spheres only collide when moving against Normal from the front of the plane.
+ */
+struct FSimplePhysicsStaticPlane
+{
+	FVector Center;
+	FVector Normal;
+
+	/** Axes of the plane rectangle */
+	FVector AxisU;
+	FVector AxisV;
+	FVector2D HalfExtents;
+
+	/** Actor reported in hit results */
+	TWeakObjectPtr<AActor> SourceActor;
+};
+
+
+/**
+ * Oriented box.
+ */
+struct FSimplePhysicsStaticBox
+{
+	FVector Center;
+	FQuat Rotation;
+	FVector HalfExtents;
+
+	/** Actor reported in hit results */
+	TWeakObjectPtr<AActor> SourceActor;
+};
+
+
+/**
+ * Snapshot of static geometry RigidBodies bounce off, tested analytically by USimplePhysicsSolver instead of sweeping
+ * through the physics scene. Built by game code, for example from a scanned room, and handed to the solver.
+ */
+struct SIMPLEPHYSICS_API FSimplePhysicsStaticColliderSet
+{
+	TArray<FSimplePhysicsStaticPlane> Planes;
+	TArray<FSimplePhysicsStaticBox> Boxes;
+
+	/**
+	 * Add a plane facing the X axis of Transform.
+	 * @param	LocalBounds		Bounds of the plane in the Y and Z axes of Transform
+	 */
+	void AddPlane(const FTransform& Transform, const FBox2D& LocalBounds, AActor* SourceActor = nullptr);
+
+	/** Add a box of LocalBounds in the space of Transform */
+	void AddBox(const FTransform& Transform, const FBox& LocalBounds, AActor* SourceActor = nullptr);
+
+	void Reset();
+
+	bool IsEmpty() const { return Planes.Num() == 0 && Boxes.Num() == 0; }
+
+	/** Read or write the collider shapes. Source actors are not serialized */
+	void Serialize(FArchive& Ar);
+
+	/**
+	 * Find the first collider a sphere touches when moving from Start by Move.
+	 * Spheres already touching a collider and moving into it report a hit at time 0.
+	 * @param	OutHit		Time is the fraction of Move before the sphere touches the collider
+	 * @return true if the sphere touches a collider during the move
+	 */
+	bool SweepSphere(const FVector& Start, const FVector& Move, float Radius, FHitResult& OutHit) const;
+
+	/**
+	 * Find how far a sphere overlapping colliders has to move to stop overlapping them.
+	 * @param	OutAdjustment	Sum of the shortest moves out of each overlapped collider
+	 * @return true if the sphere overlaps any collider
+	 */
+	bool ComputePenetration(const FVector& Center, float Radius, FVector& OutAdjustment) const;
+
+	/** Bounds of all colliders. Invalid if the set is empty */
+	FBox GetBounds() const;
+
+private:
+
+	bool SweepSpherePlane(const FSimplePhysicsStaticPlane& Plane, const FVector& Start, const FVector& Move, float Radius, float& OutTime, FVector& OutNormal, FVector& OutImpactPoint) const;
+	bool SweepSphereBox(const FSimplePhysicsStaticBox& Box, const FVector& Start, const FVector& Move, float Radius, float& OutTime, FVector& OutNormal, FVector& OutImpactPoint) const;
+};
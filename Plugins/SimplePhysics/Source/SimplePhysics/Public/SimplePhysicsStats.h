@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+
+
+DECLARE_STATS_GROUP(TEXT("SimplePhysics"), STATGROUP_SimplePhysics, STATCAT_Advanced);
+
+/** Solver phases */
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Tick"), STAT_SimplePhysics_Tick, STATGROUP_SimplePhysics, SIMPLEPHYSICS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Register"), STAT_SimplePhysics_Register, STATGROUP_SimplePhysics, SIMPLEPHYSICS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Integrate"), STAT_SimplePhysics_Integrate, STATGROUP_SimplePhysics, SIMPLEPHYSICS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Collide"), STAT_SimplePhysics_Collide, STATGROUP_SimplePhysics, SIMPLEPHYSICS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Resolve"), STAT_SimplePhysics_Resolve, STATGROUP_SimplePhysics, SIMPLEPHYSICS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Sweep"), STAT_SimplePhysics_Sweep, STATGROUP_SimplePhysics, SIMPLEPHYSICS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Writeback"), STAT_SimplePhysics_Writeback, STATGROUP_SimplePhysics, SIMPLEPHYSICS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Dispatch Events"), STAT_SimplePhysics_DispatchEvents, STATGROUP_SimplePhysics, SIMPLEPHYSICS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Scene Queries"), STAT_SimplePhysics_Query, STATGROUP_SimplePhysics, SIMPLEPHYSICS_API);
+
+/** Body and contact counts of the last frame */
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Simulating Bodies"), STAT_SimplePhysics_SimulatingBodies, STATGROUP_SimplePhysics, SIMPLEPHYSICS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Sleeping Bodies"), STAT_SimplePhysics_SleepingBodies, STATGROUP_SimplePhysics, SIMPLEPHYSICS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Added Bodies"), STAT_SimplePhysics_AddedBodies, STATGROUP_SimplePhysics, SIMPLEPHYSICS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Removed Bodies"), STAT_SimplePhysics_RemovedBodies, STATGROUP_SimplePhysics, SIMPLEPHYSICS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Contacts"), STAT_SimplePhysics_Contacts, STATGROUP_SimplePhysics, SIMPLEPHYSICS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Move Iterations"), STAT_SimplePhysics_Iterations, STATGROUP_SimplePhysics, SIMPLEPHYSICS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Aborted Moves"), STAT_SimplePhysics_Aborts, STATGROUP_SimplePhysics, SIMPLEPHYSICS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Steps"), STAT_SimplePhysics_Steps, STATGROUP_SimplePhysics, SIMPLEPHYSICS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Scene Query Count"), STAT_SimplePhysics_Queries, STATGROUP_SimplePhysics, SIMPLEPHYSICS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Quality Level"), STAT_SimplePhysics_QualityLevel, STATGROUP_SimplePhysics, SIMPLEPHYSICS_API);
+
+/** Memory of the body store and of side tables holding entries for only some bodies */
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Body Store Memory"), STAT_SimplePhysics_BodyStoreMemory, STATGROUP_SimplePhysics, SIMPLEPHYSICS_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Side Table Memory"), STAT_SimplePhysics_SideTableMemory, STATGROUP_SimplePhysics, SIMPLEPHYSICS_API);
+
+/** Insights channel for per frame solver counters. Enable with -trace=default,SimplePhysics */
+UE_TRACE_CHANNEL_EXTERN(SimplePhysicsChannel, SIMPLEPHYSICS_API);
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
+#include "Engine/EngineTypes.h"
 #include "SimplePhysics_Settings.generated.h"
 
 /**
@@ -27,4 +28,186 @@ public:
 	
 	UPROPERTY(Config, EditAnywhere, Category = "Test Settings")
 	float MinimumSimulationVelocity;
+
+	/** Sleeping RigidBodies closer than this distance in cm to a waking RigidBody are woken with it */
+	UPROPERTY(Config, EditAnywhere, Category = "Sleeping", meta = (ClampMin = "0"))
+	float WakeContactTolerance;
+
+	/**
+	 * Sequential impulse iterations over all RigidBody vs RigidBody contacts each step. More iterations resolve clusters
+	 * of touching RigidBodies more accurately at a higher cost. 1 resolves every contact once in time of impact order.
+	 */
+	UPROPERTY(Config, EditAnywhere, Category = "Contact Solver", meta = (ClampMin = "1"))
+	int32 ContactSolverIterations;
+
+	/**
+	 * Keep contacts between steps. RigidBody pairs start the contact solver from the impulse of the previous step, and RigidBodies resting
+	 * on a surface slide along it in a single move instead of bouncing off it again every step.
+	 */
+	UPROPERTY(Config, EditAnywhere, Category = "Contact Solver")
+	bool bWarmStartContacts;
+
+	/** Fraction of the previous impulse of a RigidBody pair applied before solving. Below 1 to damp jitter when contacts change */
+	UPROPERTY(Config, EditAnywhere, Category = "Contact Solver", meta = (ClampMin = "0", ClampMax = "1", EditCondition = "bWarmStartContacts"))
+	float ContactWarmStartFactor;
+
+	/** RigidBodies approaching a surface slower than this in cm/s are resting on it rather than bouncing off it */
+	UPROPERTY(Config, EditAnywhere, Category = "Contact Solver", meta = (ClampMin = "0", EditCondition = "bWarmStartContacts"))
+	float RestingContactSpeed;
+
+	/** Steps a resting contact is kept without a sweep hitting the surface again */
+	UPROPERTY(Config, EditAnywhere, Category = "Contact Solver", meta = (ClampMin = "1", EditCondition = "bWarmStartContacts"))
+	int32 RestingContactLifetimeSteps;
+
+	/**
+	 * Push RigidBodies that start a move stuck inside geometry, or end a step overlapping a static collider or another RigidBody,
+	 * out along the shortest way at the end of the step, instead of aborting their move again every step
+	 */
+	UPROPERTY(Config, EditAnywhere, Category = "Depenetration")
+	bool bDepenetrateStuckBodies;
+
+	/** Largest distance in cm a stuck RigidBody is pushed in one step */
+	UPROPERTY(Config, EditAnywhere, Category = "Depenetration", meta = (ClampMin = "0", EditCondition = "bDepenetrateStuckBodies"))
+	float MaxDepenetrationDistance;
+
+	/**
+	 * Stop simulating RigidBodies that leave the bounds of the static colliders, such as the scanned room, and send
+	 * USimplePhysicsRigidBodyComponent::OnEscapedDelegate so game code can recycle them
+	 */
+	UPROPERTY(Config, EditAnywhere, Category = "Escaped Bodies")
+	bool bDetectEscapedBodies;
+
+	/** Distance in cm a RigidBody has to be outside the static collider bounds to count as escaped */
+	UPROPERTY(Config, EditAnywhere, Category = "Escaped Bodies", meta = (ClampMin = "0", EditCondition = "bDetectEscapedBodies"))
+	float EscapedBodyMargin;
+
+	/**
+	 * Keep the last blocking hit of every RigidBody for USimplePhysicsRigidBodyComponent::GetLastHitResult(). Costs a hit result per RigidBody that hit anything,
+	 * disable if no game code reads them.
+	 */
+	UPROPERTY(Config, EditAnywhere, Category = "Debug")
+	bool bKeepLastHitResults;
+
+	/** Size of a broadphase grid cell in cm. Set to 0 to use twice the largest RigidBody radius each tick */
+	UPROPERTY(Config, EditAnywhere, Category = "Broadphase", meta = (ClampMin = "0"))
+	float BroadphaseCellSize;
+
+	/**
+	 * Object type assigned to RigidBodies added to the broadphase. RigidBodies ignore this channel when sweeping,
+	 * so RigidBody vs RigidBody contacts are only found by the solver broadphase and never by an engine sweep.
+	 * Should be an object channel only used by RigidBodies, the project defines SimplePhysicsBody for this.
+	 */
+	UPROPERTY(Config, EditAnywhere, Category = "Broadphase")
+	TEnumAsByte<ECollisionChannel> RigidBodyObjectType;
+
+	/**
+	 * Move RigidBodies that have no broadphase candidates and no other blocking primitive in the way this step without an engine sweep. RigidBodies with no static collider hit
+	 * have their transforms written at the end of the step without updating overlaps, the others are moved up to the static collider. Only used while static colliders are set,
+	 * as the solver can not prove a move is free of contacts without them.
+	 */
+	UPROPERTY(Config, EditAnywhere, Category = "Broadphase")
+	bool bTeleportContactFreeBodies;
+
+	/** Integrate free flight movement of simulating RigidBodies on worker threads */
+	UPROPERTY(Config, EditAnywhere, Category = "Threading")
+	bool bParallelIntegration;
+
+	/** Minimum number of RigidBodies integrated by a single worker task. Smaller batches are not worth the scheduling cost */
+	UPROPERTY(Config, EditAnywhere, Category = "Threading", meta = (ClampMin = "1", EditCondition = "bParallelIntegration"))
+	int32 ParallelIntegrationBatchSize;
+
+	/**
+	 * Integrate, update the broadphase and find contacts for the next step on a worker task while the rest of the frame runs.
+	 * Inputs made while the task runs are applied at the start of the next frame, so queries return the state before them until then.
+	 * Removing bodies and changing the static colliders or simulation bounds wait for the task instead.
+	 * Only used with a fixed timestep and no substepping. The prepared step is dropped whenever an input or moving a body
+	 * changed the state it was prepared from.
+	 */
+	UPROPERTY(Config, EditAnywhere, Category = "Threading")
+	bool bAsyncStepping;
+
+	/** Step the simulation with FixedTimestep instead of the frame delta time. Results no longer depend on the frame rate */
+	UPROPERTY(Config, EditAnywhere, Category = "Fixed Timestep")
+	bool bUseFixedTimestep;
+
+	/** Duration of a single simulation step in seconds */
+	UPROPERTY(Config, EditAnywhere, Category = "Fixed Timestep", meta = (ClampMin = "0.001", EditCondition = "bUseFixedTimestep"))
+	float FixedTimestep;
+
+	/** Max simulation steps in a single frame. Time beyond this is dropped so a hitch does not cause more work the following frames */
+	UPROPERTY(Config, EditAnywhere, Category = "Fixed Timestep", meta = (ClampMin = "1", EditCondition = "bUseFixedTimestep"))
+	int32 MaxStepsPerFrame;
+
+	/** Place RigidBodies between their last two simulated locations so movement looks smooth when the frame rate and step rate differ */
+	UPROPERTY(Config, EditAnywhere, Category = "Fixed Timestep", meta = (EditCondition = "bUseFixedTimestep"))
+	bool bInterpolateFixedSteps;
+
+	/**
+	 * Split each step into substeps where all RigidBodies move together, so RigidBodies collide against current locations of each other.
+	 * The number of substeps is chosen from the fastest RigidBody and the smallest RigidBody radius.
+	 */
+	UPROPERTY(Config, EditAnywhere, Category = "Substepping")
+	bool bUseSubstepping;
+
+	/** Max substeps in a single step */
+	UPROPERTY(Config, EditAnywhere, Category = "Substepping", meta = (ClampMin = "1", EditCondition = "bUseSubstepping"))
+	int32 MaxSubsteps;
+
+	/** Fraction of the smallest RigidBody radius the fastest RigidBody may travel in a single substep */
+	UPROPERTY(Config, EditAnywhere, Category = "Substepping", meta = (ClampMin = "0.01", EditCondition = "bUseSubstepping"))
+	float SubstepMaxTravelFraction;
+
+	/**
+	 * Move RigidBodies far from the player camera every 2nd or 4th step instead of every step, covering the skipped time in one move.
+	 * RigidBodies with the same rate are spread over the steps, so every step moves a similar number of RigidBodies.
+	 */
+	UPROPERTY(Config, EditAnywhere, Category = "Significance")
+	bool bUseSignificance;
+
+	/** RigidBodies closer than this distance in cm to the camera move every step */
+	UPROPERTY(Config, EditAnywhere, Category = "Significance", meta = (ClampMin = "0", EditCondition = "bUseSignificance"))
+	float SignificanceFullRateDistance;
+
+	/** RigidBodies closer than this distance in cm to the camera move every 2nd step, RigidBodies further away every 4th step */
+	UPROPERTY(Config, EditAnywhere, Category = "Significance", meta = (ClampMin = "0", EditCondition = "bUseSignificance"))
+	float SignificanceHalfRateDistance;
+
+	/** Halve the rate again for RigidBodies outside a cone of the camera horizontal field of view and beyond SignificanceFullRateDistance */
+	UPROPERTY(Config, EditAnywhere, Category = "Significance", meta = (EditCondition = "bUseSignificance"))
+	bool bReduceRateOutOfView;
+
+	/**
+	 * Lower the solver quality when the solver takes longer than FrameBudgetMilliseconds on the game thread, and raise it again once
+	 * the cost has stayed well below the budget. Quality goes from the values above down to the LowestQuality values.
+	 */
+	UPROPERTY(Config, EditAnywhere, Category = "Frame Budget")
+	bool bUseFrameBudget;
+
+	/** Game thread time in milliseconds the solver should stay under each frame */
+	UPROPERTY(Config, EditAnywhere, Category = "Frame Budget", meta = (ClampMin = "0.01", EditCondition = "bUseFrameBudget"))
+	float FrameBudgetMilliseconds;
+
+	/** Number of quality levels between full quality and the LowestQuality values */
+	UPROPERTY(Config, EditAnywhere, Category = "Frame Budget", meta = (ClampMin = "2", EditCondition = "bUseFrameBudget"))
+	int32 FrameBudgetQualityLevels;
+
+	/** Quality is only raised once the cost stayed below this fraction of the budget for FrameBudgetRecoverFrames frames */
+	UPROPERTY(Config, EditAnywhere, Category = "Frame Budget", meta = (ClampMin = "0", ClampMax = "1", EditCondition = "bUseFrameBudget"))
+	float FrameBudgetRecoverFraction;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Frame Budget", meta = (ClampMin = "1", EditCondition = "bUseFrameBudget"))
+	int32 FrameBudgetRecoverFrames;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Frame Budget", meta = (ClampMin = "1", EditCondition = "bUseFrameBudget"))
+	int32 LowestQualitySimulationIterations;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Frame Budget", meta = (ClampMin = "1", EditCondition = "bUseFrameBudget"))
+	int32 LowestQualityContactSolverIterations;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Frame Budget", meta = (ClampMin = "1", EditCondition = "bUseFrameBudget"))
+	int32 LowestQualityMaxSubsteps;
+
+	/** Higher values put RigidBodies to sleep sooner at low quality */
+	UPROPERTY(Config, EditAnywhere, Category = "Frame Budget", meta = (ClampMin = "0", EditCondition = "bUseFrameBudget"))
+	float LowestQualityMinimumSimulationVelocity;
 };
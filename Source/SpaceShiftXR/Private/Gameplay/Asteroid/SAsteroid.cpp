@@ -9,6 +9,7 @@
 #include "Gameplay/Asteroid/SAsteroidSpawner.h"
 #include "Gameplay/Asteroid/SAsteroidMovementComponent.h"
 #include "SimplePhysicsRigidBodyComponent.h"
+#include "SimplePhysicsSolver.h"
 #include "SPoolSubsystem.h"
 
 
@@ -32,6 +33,10 @@ ASAsteroid::ASAsteroid()
 
 	//AstroidMovementComp = CreateDefaultSubobject<USAsteroidMovementComponent>(TEXT("MovementComp"));
 	SimpleRigidBodyComp = CreateDefaultSubobject<USimplePhysicsRigidBodyComponent>(TEXT("SimplePhysicsRigidBody"));
+
+	FragmentIgnoreSiblingsTime = 0.5f;
+	DestructionImpulseRadius = 0.f;
+	DestructionImpulseStrength = 100.f;
 }
 
 
@@ -44,6 +49,8 @@ void ASAsteroid::BeginPlay()
 {
 	Super::BeginPlay();
 
+	SimpleRigidBodyComp->OnEscapedDelegate.AddDynamic(this, &ASAsteroid::OnRigidBodyEscaped);
+
 #if WITH_EDITOR
 	//if (DataAsset)
 	//{
@@ -193,14 +200,19 @@ const TArray<FVector>& ASAsteroid::GetFragmentSpawnPositions() const
 }
 
 
-void ASAsteroid::OnSpawnFromPool()
+void ASAsteroid::OnSpawnFromPool_Implementation()
 {
-	
+	bInPool = false;
 }
 
 
-void ASAsteroid::OnReturnToPool()
+void ASAsteroid::OnReturnToPool_Implementation()
 {
+	bInPool = true;
+
+	// Pooled asteroids must not keep moving, or leave the room and be returned again
+	SimpleRigidBodyComp->SetSimulationEnabled(false);
+
 	if (MeshComp)
 	{
 		MeshComp->SetVisibility(false, true);
@@ -241,8 +253,18 @@ void ASAsteroid::AsteroidDestroyed()
 
 	if (auto Subsystem = GetPoolSubsystem())
 	{
+		USimplePhysicsSolver* Solver = SimpleRigidBodyComp->GetSimplePhysicsSolver();
+
+		// Push neighbours before fragments spawn, fragments get their own outward velocity
+		if (Solver && DestructionImpulseRadius > 0.f)
+		{
+			Solver->ApplyRadialImpulse(GetActorLocation(), DestructionImpulseRadius, DestructionImpulseStrength, RIF_Linear, true);
+		}
+
 		if (bHasFragments)
 		{
+			const int32 FragmentGroup = Solver ? Solver->NewIgnoreGroup() : 0;
+
 			for (const auto& Position : FragmentSpawnPositions)
 			{
 				const FVector WorldPosition = Position + GetActorLocation();
@@ -252,6 +274,12 @@ void ASAsteroid::AsteroidDestroyed()
 					Asteroid->InitializeAsteroid(DataAsset->AsteroidFragments);
 					Asteroid->SimpleRigidBodyComp->SetSimulationEnabled(true);
 
+					// Fragments spawn overlapping each other, let them separate before they collide
+					if (FragmentGroup != 0)
+					{
+						Asteroid->SimpleRigidBodyComp->SetIgnoreGroup(FragmentGroup, FragmentIgnoreSiblingsTime);
+					}
+
 					FVector Direction = Asteroid->GetActorLocation() - GetActorLocation();
 					Direction.Normalize();
 
@@ -272,6 +300,26 @@ void ASAsteroid::AsteroidDestroyed()
 }
 
 
+void ASAsteroid::OnRigidBodyEscaped()
+{
+	// Escape events are sent after bounce events, which may have destroyed the asteroid already
+	if (bInPool)
+	{
+		return;
+	}
+
+	UE_LOG(LogTemp, Verbose, TEXT("Asteroid %s left the room"), *GetName());
+	if (auto Subsystem = GetPoolSubsystem())
+	{
+		Subsystem->ReturnToPool(this);
+	}
+	else
+	{
+		Destroy();
+	}
+}
+
+
 USPoolSubsystem* ASAsteroid::GetPoolSubsystem() const
 {
 	if (const UWorld* World = GetWorld())
@@ -285,7 +333,7 @@ USPoolSubsystem* ASAsteroid::GetPoolSubsystem() const
 void ASAsteroid::SetVelocity(const FVector& Velocity)
 {
 	SimpleRigidBodyComp->SetSimulationEnabled(true);
-	SimpleRigidBodyComp->Velocity = Velocity;
+	SimpleRigidBodyComp->SetVelocity(Velocity);
 }
 
 #if WITH_EDITOR
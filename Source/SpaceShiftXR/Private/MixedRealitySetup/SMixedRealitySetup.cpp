@@ -4,6 +4,10 @@
 #include "MixedRealitySetup/SMixedRealitySetup.h"
 
 #include "MixedRealitySetup/SMixedRealitySetupCommands.h"
+#include "MRUtilityKitAnchor.h"
+#include "MRUtilityKitRoom.h"
+#include "MRUtilityKitSubsystem.h"
+#include "SimplePhysicsSolver.h"
 
 
 // Sets default values
@@ -135,9 +139,63 @@ void ASMixedRealitySetup::CompleteSetup()
 	bSetupInProgress = false;
 
 	UE_LOG(SMixedRealitySetup, Log, TEXT("Setup Complete Status: %s"), *UEnum::GetValueAsString(SetupState));
+
+	if (SetupState == ESetupState::ESS_Complete)
+	{
+		SnapshotRoomColliders();
+	}
+
 	OnSetupComplete.Broadcast(SetupState == ESetupState::ESS_Complete);
 }
 
+void ASMixedRealitySetup::SnapshotRoomColliders()
+{
+	UWorld* World = GetWorld();
+	USimplePhysicsSolver* Solver = World ? World->GetSubsystem<USimplePhysicsSolver>() : nullptr;
+	UMRUKSubsystem* MRUKSubsystem = GetGameInstance() ? GetGameInstance()->GetSubsystem<UMRUKSubsystem>() : nullptr;
+	AMRUKRoom* Room = MRUKSubsystem ? MRUKSubsystem->GetCurrentRoom() : nullptr;
+
+	if (!Solver || !Room)
+	{
+		UE_LOG(SMixedRealitySetup, Warning, TEXT("Unable to snapshot room colliders, asteroids will collide with the room through physics queries"));
+		return;
+	}
+
+	FSimplePhysicsStaticColliderSet Colliders;
+	TArray<AActor*> ColliderActors;
+
+	// Floor, ceiling and walls face into the room along their X axis
+	auto AddPlaneAnchor = [&Colliders, &ColliderActors](AMRUKAnchor* Anchor)
+	{
+		if (Anchor && Anchor->PlaneBounds.bIsValid)
+		{
+			Colliders.AddPlane(Anchor->GetActorTransform(), Anchor->PlaneBounds, Anchor);
+			ColliderActors.Add(Anchor);
+		}
+	};
+
+	AddPlaneAnchor(Room->FloorAnchor);
+	AddPlaneAnchor(Room->CeilingAnchor);
+
+	for (AMRUKAnchor* Wall : Room->WallAnchors)
+	{
+		AddPlaneAnchor(Wall);
+	}
+
+	// Furniture and other volumes
+	for (AMRUKAnchor* Anchor : Room->AllAnchors)
+	{
+		if (Anchor && Anchor != Room->GlobalMeshAnchor && !ColliderActors.Contains(Anchor) && Anchor->VolumeBounds.IsValid)
+		{
+			Colliders.AddBox(Anchor->GetActorTransform(), Anchor->VolumeBounds, Anchor);
+			ColliderActors.Add(Anchor);
+		}
+	}
+
+	UE_LOG(SMixedRealitySetup, Log, TEXT("Room colliders: %d planes, %d boxes"), Colliders.Planes.Num(), Colliders.Boxes.Num());
+	Solver->SetStaticColliders(Colliders, ColliderActors);
+}
+
 void ASMixedRealitySetup::BeginSetup()
 {
 	BuildCommandQueue();
@@ -42,9 +42,9 @@ public:
 	UFUNCTION(BlueprintCallable)
 	const TArray<FVector>& GetFragmentSpawnPositions() const;
 
-	void OnSpawnFromPool();
+	virtual void OnSpawnFromPool_Implementation() override;
 
-	void OnReturnToPool();
+	virtual void OnReturnToPool_Implementation() override;
 
 
 	USPoolSubsystem* GetPoolSubsystem() const;
@@ -58,6 +58,18 @@ public:
 	UPROPERTY(EditAnywhere)
 	float FragmentTestForce;
 
+	/** Seconds fragments of this asteroid ignore collisions with each other after spawning */
+	UPROPERTY(EditAnywhere)
+	float FragmentIgnoreSiblingsTime;
+
+	/** Radius of the shockwave pushing nearby asteroids away when this asteroid is destroyed. 0 disables the shockwave */
+	UPROPERTY(EditAnywhere)
+	float DestructionImpulseRadius;
+
+	/** Velocity change of asteroids at the center of the shockwave. Fades to 0 at DestructionImpulseRadius */
+	UPROPERTY(EditAnywhere)
+	float DestructionImpulseStrength;
+
 protected:
 
 #if WITH_EDITOR
@@ -99,12 +111,19 @@ private:
 	
 	TArray<FVector> FragmentSpawnPositions;
 
+	/** Set while the asteroid waits in its pool, so late events do not return it again */
+	bool bInPool = false;
+
 	
 
 	FVector GetRandomPointInUnitSphere() const;
 
 	void GenerateFragmentSpawnLocations();
 
+	/** Return the asteroid to the pool once it left the room, the solver already stopped simulating it */
+	UFUNCTION()
+	void OnRigidBodyEscaped();
+
 	
 
 public:	
@@ -72,6 +72,9 @@ private:
 
 	void CompleteSetup();
 
+	/** Give the current room geometry to the SimplePhysics solver as analytic static colliders */
+	void SnapshotRoomColliders();
+
 	void BeginSetup();
 
 	ESetupState SetupState;